@@ -183,6 +183,12 @@ struct nvdla_op_desc<NvDlaOpType::sdp>
   using type = dla_sdp_op_desc;
 };
 
+template <>
+struct nvdla_op_desc<NvDlaOpType::rubik>
+{
+  using type = dla_rubik_op_desc;
+};
+
 template <NvDlaOpType type>
 typename nvdla_op_desc<type>::type& getDesc(NvDlaDlaOperation& operation);
 
@@ -193,6 +199,13 @@ nvdla_op_desc<NvDlaOpType::sdp>::type& getDesc<NvDlaOpType::sdp>(NvDlaDlaOperati
   return operation.op_desc.sdp_op;
 }
 
+template <>
+nvdla_op_desc<NvDlaOpType::rubik>::type& getDesc<NvDlaOpType::rubik>(NvDlaDlaOperation& operation)
+{
+  assert(operation.op_dep.op_type == NvDlaOpType::rubik);
+  return operation.op_desc.rubik_op;
+}
+
 template <NvDlaOpType type>
 struct nvdla_op_surface;
 
@@ -202,6 +215,12 @@ struct nvdla_op_surface<NvDlaOpType::sdp>
   using type = dla_sdp_surface_desc;
 };
 
+template <>
+struct nvdla_op_surface<NvDlaOpType::rubik>
+{
+  using type = dla_rubik_surface_desc;
+};
+
 template <NvDlaOpType type>
 typename nvdla_op_surface<type>::type& getSurface(NvDlaDlaOperation& operation);
 
@@ -212,6 +231,13 @@ nvdla_op_surface<NvDlaOpType::sdp>::type& getSurface<NvDlaOpType::sdp>(NvDlaDlaO
   return operation.op_surf.sdp_surface;
 }
 
+template <>
+nvdla_op_surface<NvDlaOpType::rubik>::type& getSurface<NvDlaOpType::rubik>(NvDlaDlaOperation& operation)
+{
+  assert(operation.op_dep.op_type == NvDlaOpType::rubik);
+  return operation.op_surf.rubik_surface;
+}
+
 NvDlaCubeInfo makeCubeInfo(const NvDlaConstants& constants, nvdla_cube_type type, Tensor::Dimension n,
                            Tensor::Dimension c, Tensor::Dimension h, Tensor::Dimension w)
 {
@@ -307,7 +333,52 @@ void CodeEmitVisitor::visit(const Conv& pConv)
 
 void CodeEmitVisitor::visit(const NvDlaShuffle& pOp)
 {
-  
+  // A Shuffle views the C = g * n input channels as a [g, n] matrix and
+  // transposes it, so output channel i2 * g + i1 is input channel i1 * n + i2.
+  // RUBIK can not permute channels, but it may write planes at any stride,
+  // so the transpose is done by 2 + 2 * g operations:
+  //
+  //   1. split the input into C planes, plane c at c * stride of buffer X.
+  //   2. merge planes i1 * n ... i1 * n + n - 1 of X into feature cube Y.
+  //   3. split Y into planes i1, i1 + g, ... of buffer Z.
+  //   4. merge the C planes of Z into the output.
+  //
+  // Steps 2 and 3 are repeated for every i1 in [0, g). They run in order on
+  // RUBIK, so Y is reused.
+  const Tensor&           input     = *pOp.getInput(0);
+  const Tensor&           output    = *pOp.getOutput(0);
+  const NvDlaDims         dims(input);
+  const Tensor::Dimension numGroups = pOp.getGroup().value();
+  const Tensor::Dimension groupSize = dims.c / numGroups;
+  assert(dims.n == 1 && dims.c % numGroups == 0 && "Shuffle must split the channels evenly");
+
+  const std::uint32_t lineStride  = UNIT_ALIGNMENT(dims.w * ELEMENT_SIZE, FEATURE_ATOM_CUBE_SIZE);
+  const std::uint32_t planeStride = lineStride * dims.h;
+
+  const NvDlaCubeInfo inputCube  = makeCubeInfo(*this, NVDLA_CUBE_FEATURE, input);
+  const NvDlaCubeInfo outputCube = makeCubeInfo(*this, NVDLA_CUBE_FEATURE, output);
+  const NvDlaCubeInfo groupCube  = makeCubeInfo(*this, NVDLA_CUBE_FEATURE, 1, groupSize, dims.h, dims.w);
+  const NvDlaCubeInfo planesCube = makePlanarCubeInfo(dims.c, dims.h, dims.w, planeStride);
+  const NvDlaCubeInfo fromCube   = makePlanarCubeInfo(groupSize, dims.h, dims.w, planeStride);
+  const NvDlaCubeInfo toCube     = makePlanarCubeInfo(groupSize, dims.h, dims.w, planeStride * numGroups);
+
+  const auto allocate = [this](std::uint32_t size) {
+    return m_pMeta.allocateMemory(ILoadable::MemoryDomain_SYSMEM, ILoadable::MemoryFlags_ALLOC, size);
+  };
+  const MemoryListEntryId bufferX = allocate(planesCube.size);
+  const MemoryListEntryId bufferY = allocate(groupCube.size);
+  const MemoryListEntryId bufferZ = allocate(planesCube.size);
+
+  emitRubik(RUBIK_MODE_SPLIT, issueDlaAddr(input, inputCube), inputCube, issueDlaAddr(bufferX, planesCube),
+            planesCube);
+  for (Tensor::Dimension group = 0; group < numGroups; ++group) {
+    emitRubik(RUBIK_MODE_MERGE, m_pMeta.acquireMemory(bufferX, group * groupSize * planeStride), fromCube,
+              issueDlaAddr(bufferY, groupCube), groupCube);
+    emitRubik(RUBIK_MODE_SPLIT, issueDlaAddr(bufferY, groupCube), groupCube,
+              m_pMeta.acquireMemory(bufferZ, group * planeStride), toCube);
+  }
+  emitRubik(RUBIK_MODE_MERGE, issueDlaAddr(bufferZ, planesCube), planesCube, issueDlaAddr(output, outputCube),
+            outputCube);
 }
 
 MemoryListEntryId CodeEmitVisitor::packWeight(const Tensor& weight, NvDlaDims destDims,
@@ -710,6 +781,37 @@ void CodeEmitVisitor::emitSdp(std::uint8_t opType, const Tensor& first, const Te
   issueDlaOp(std::move(operation));
 }
 
+void CodeEmitVisitor::emitRubik(std::uint8_t mode, AddressListEntryId srcAddress, const NvDlaCubeInfo& srcCube,
+                                AddressListEntryId dstAddress, const NvDlaCubeInfo& dstCube)
+{
+  assert(mode == RUBIK_MODE_SPLIT || mode == RUBIK_MODE_MERGE);
+
+  auto operation = makeNvDlaOp(NvDlaOpType::rubik);
+
+  auto& desc     = getDesc<NvDlaOpType::rubik>(*operation);
+  desc.mode      = mode;
+  desc.precision = DLA_PRECISION;
+  desc.stride_x  = 0; // only for RUBIK_MODE_CONTRACT
+  desc.stride_y  = 0;
+
+  auto& surface = getSurface<NvDlaOpType::rubik>(*operation);
+  NvDlaDataCubeModifier(surface.src_data, NvDlaMemType::mc).setAddress(srcAddress).setSize(srcCube.size).setInfo(srcCube);
+  NvDlaDataCubeModifier(surface.dst_data, NvDlaMemType::mc).setAddress(dstAddress).setSize(dstCube.size).setInfo(dstCube);
+
+  issueDlaOp(std::move(operation));
+}
+
+NvDlaCubeInfo CodeEmitVisitor::makePlanarCubeInfo(Tensor::Dimension c, Tensor::Dimension h, Tensor::Dimension w,
+                                                  std::uint32_t planeStride) const
+{
+  NvDlaCubeInfo cube  = makeCubeInfo(*this, NVDLA_CUBE_FEATURE, 1, c, h, w);
+  cube.stride_line    = UNIT_ALIGNMENT(w * ELEMENT_SIZE, FEATURE_ATOM_CUBE_SIZE);
+  cube.stride_surface = 0;
+  cube.stride_plane   = planeStride;
+  cube.size           = planeStride * (c - 1) + cube.stride_line * h;
+  return cube;
+}
+
 void CodeEmitVisitor::packSDPOperandImpl(NvU8* blob, const Tensor* aluTensor, const float* aluData,
                                          const Tensor* mulTensor, const float* mulData, const NvDlaCubeInfo& cubeInfo)
 {
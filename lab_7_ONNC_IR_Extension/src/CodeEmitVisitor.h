@@ -84,6 +84,20 @@ private:
   //
   void emitSdp(std::uint8_t opType, const Tensor& firstInput, const Tensor& secondInput, const Tensor& output);
 
+  // Perform RUBIK for a source and a destination cube in memory, the possible
+  // value for parameter 'mode' is:
+  //
+  //   1. RUBIK_MODE_SPLIT (feature cube to planes)
+  //   2. RUBIK_MODE_MERGE (planes to feature cube)
+  //
+  void emitRubik(std::uint8_t mode, AddressListEntryId srcAddress, const NvDlaCubeInfo& srcCube,
+                 AddressListEntryId dstAddress, const NvDlaCubeInfo& dstCube);
+
+  // A planar cube stores every channel as a plane of h lines, 'planeStride'
+  // bytes apart.
+  NvDlaCubeInfo makePlanarCubeInfo(Tensor::Dimension c, Tensor::Dimension h, Tensor::Dimension w,
+                                   std::uint32_t planeStride) const;
+
 private:
   MemoryListEntryId packWeight(span<const float> weight, const Tensor* weightTensor, NvDlaDims srcDims,
                                NvDlaDims destDims, Tensor::Dimension numFrontPaddingChannels,
@@ -15,6 +15,7 @@
 #include "NvDlaTaskSubmitPass.h"
 #include "NvDlaFileGenPass.h"
 #include "NvDlaIdentifyShufflePass.h"
+#include "NvDlaFoldShufflePass.h"
 #include "PrintONNCIRPass.h"
 
 #include <onnc/Analysis/UpdateGraphOutputSize.h>
@@ -51,6 +52,9 @@ const Version FooNvdlaBackend::LOADABLE_VERSION = Version(1, 1, 255);
 const Version FooNvdlaBackend::BLOB_DLA_VERSION = Version(1, 3, 0);
 const Version FooNvdlaBackend::BLOB_EMU_VERSION = Version(1, 3, 0);
 
+// fold a Shuffle into a neighbouring Conv, false emits every Shuffle to RUBIK (models/test_Shuffle)
+const bool FooNvdlaBackend::FOLD_SHUFFLE = true;
+
 FooNvdlaBackend::FooNvdlaBackend(const TargetOptions& pOptions)
   : TargetBackend(pOptions)
   , NvDlaConstants(getConfig(::nvdla::ConfigSet::nv_full, ::nvdla::ExecutionMode::direct, false))
@@ -79,6 +83,10 @@ void FooNvdlaBackend::addOnncIrOptimization(PassManager& pPM, OptimizationOption
   pPM.add<PrintONNCIRPass>();
   pPM.add<NvDlaIdentifyShufflePass>();
   pPM.add<PrintONNCIRPass>();
+  if (FOLD_SHUFFLE) {
+    pPM.add<NvDlaFoldShufflePass>();
+    pPM.add<PrintONNCIRPass>();
+  }
 }
 
 void FooNvdlaBackend::addTensorSched(PassManager& pPM)
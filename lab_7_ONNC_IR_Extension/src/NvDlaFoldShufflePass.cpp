@@ -0,0 +1,332 @@
+//===- NvDlaFoldShufflePass.cpp -------------------------------------------===//
+//
+//                             The ONNC Project
+//
+// See LICENSE.TXT for details.
+//
+//===----------------------------------------------------------------------===//
+#include "NvDlaFoldShufflePass.h"
+
+#include "Compute/NvDlaShuffle.h"
+#include "NvDlaDefine.h"
+
+#include <onnc/Core/PassSupport.h>
+#include <onnc/IR/Compute/Conv.h>
+#include <onnc/IR/Compute/Initializer.h>
+
+#include <algorithm>
+#include <iostream>
+#include <string>
+#include <vector>
+
+using namespace onnc;
+using namespace foonvdla;
+
+namespace {
+
+using Permutation = std::vector<std::size_t>;
+
+/// Output channel j of a Shuffle reads input channel perm[j]. The channels are
+/// viewed as a [group, C / group] matrix and transposed.
+Permutation getPermutation(const NvDlaShuffle& shuffle)
+{
+  const std::size_t numChannels = shuffle.getInput(0)->dimension(1);
+  const std::size_t group       = shuffle.getGroup().value();
+
+  Permutation perm(numChannels);
+  for (std::size_t j = 0; j < numChannels; ++j) {
+    perm[j] = (j % group) * (numChannels / group) + j / group;
+  }
+  return perm;
+}
+
+/// The permutation moves no channel out of its group of a Conv with @ref group groups.
+bool isWithinGroups(const Permutation& perm, std::size_t group)
+{
+  const std::size_t groupSize = perm.size() / group;
+  for (std::size_t j = 0; j < perm.size(); ++j) {
+    if (perm[j] / groupSize != j / groupSize) {
+      return false;
+    }
+  }
+  return true;
+}
+
+FloatTensor* getConstant(Tensor* tensor)
+{
+  FloatTensor* constant = dynamic_cast<FloatTensor*>(tensor);
+  if (constant == nullptr || !isa<Initializer>(static_cast<ComputeOperator*>(constant->getDefine()))) {
+    return nullptr;
+  }
+
+  std::size_t size = 1;
+  for (auto dim : constant->getDimensions()) {
+    size *= dim;
+  }
+  return (constant->getValues().size() == size ? constant : nullptr);
+}
+
+bool isFoldable(const NvDlaShuffle& shuffle, Conv& conv)
+{
+  if (shuffle.getInput(0)->getNumOfDimensions() != 4 || shuffle.getGroup().value() <= 0 ||
+      shuffle.getInput(0)->dimension(1) % shuffle.getGroup().value() != 0) {
+    return false;
+  }
+
+  for (unsigned idx = 1; idx < conv.getNumOfInputs(); ++idx) {
+    if (getConstant(conv.getInput(idx)) == nullptr) {
+      return false;
+    }
+  }
+  return conv.getNumOfInputs() >= 2 && isWithinGroups(getPermutation(shuffle), conv.getGroup().value());
+}
+
+bool hasFoldableProducer(const ComputeOperator& op)
+{
+  const NvDlaShuffle& shuffle = *dyn_cast<NvDlaShuffle>(&op);
+  Conv*               conv    = dyn_cast<Conv>(static_cast<ComputeOperator*>(shuffle.getInput(0)->getDefine()));
+  return conv != nullptr && isFoldable(shuffle, *conv);
+}
+
+bool hasFoldableConsumer(const ComputeOperator& op)
+{
+  // The Shuffle result must be the data input, not a weight.
+  Conv&               conv    = *dyn_cast<Conv>(const_cast<ComputeOperator*>(&op));
+  const NvDlaShuffle* shuffle = dyn_cast<NvDlaShuffle>(static_cast<ComputeOperator*>(conv.getInput(0)->getDefine()));
+  return shuffle != nullptr && isFoldable(*shuffle, conv);
+}
+
+FloatTensor* addConstant(ComputeGraph& pCG, FloatTensor& prototype, const std::string& name)
+{
+  FloatTensor* constant = dynamic_cast<FloatTensor*>(prototype.create());
+  constant->setName(name);
+  constant->setDimensions(prototype.getDimensions());
+  constant = pCG.addValue<FloatTensor>(constant);
+
+  Initializer* initializer = pCG.addOperator<Initializer>();
+  initializer->setTensor(*constant);
+  return constant;
+}
+
+/// Erase a constant which is not read anymore, with its Initializer.
+void eraseIfUnused(ComputeGraph& pCG, Tensor& constant)
+{
+  if (!constant.getUses().empty()) {
+    return;
+  }
+
+  ComputeOperator* initializer = static_cast<ComputeOperator*>(constant.getDefine());
+  initializer->removeAllOutputs();
+  pCG.erase(*initializer);
+  pCG.erase(constant);
+}
+
+} // namespace
+
+//===----------------------------------------------------------------------===//
+// NvDlaFoldShufflePass
+//===----------------------------------------------------------------------===//
+unsigned NvDlaFoldShufflePass::tensorIdx = 0;
+
+NvDlaFoldShufflePass::NvDlaFoldShufflePass()
+{
+  // Folding into the producer is tried first. It keeps the weights of the
+  // consumer, which may be shared.
+  //
+  //       |                   |
+  //    (conv)             (shuffle)
+  //       |                   |
+  //  conv_out_tensor    shuffle_out_tensor
+  //       |                   |      // These tensors must have only one user.
+  //   (shuffle)            (conv)
+  //       |                   |
+  //
+  m_Patterns.add(NvDlaPattern("ConvShuffle")
+                   .op<Conv>().singleUse()
+                   .op<NvDlaShuffle>().where(hasFoldableProducer));
+  m_Patterns.add(NvDlaPattern("ShuffleConv")
+                   .op<NvDlaShuffle>().singleUse()
+                   .op<Conv>().where(hasFoldableConsumer));
+}
+
+Pass::ReturnType NvDlaFoldShufflePass::runOnModule(Module& pModule)
+{
+  Pass::ReturnType ret = kModuleNoChanged;
+
+  ret = BaseType::runOnModule(pModule);
+
+  if (ret != kModuleNoChanged) {
+    pModule.eraseUnusedValues();
+  }
+
+  return ret;
+}
+
+Pass::ReturnType NvDlaFoldShufflePass::runOnComputeGraph(ComputeGraph& pCG)
+{
+  Pass::ReturnType ret = Pass::kModuleNoChanged;
+
+  // A Conv may be next to two Shuffles, and the matches do not overlap, so
+  // match again until every foldable Shuffle is gone.
+  unsigned numOfFolded = 0;
+  for (NvDlaPatternSet::MatchList matches = m_Patterns.match(pCG); !matches.empty();
+       matches = m_Patterns.match(pCG)) {
+    for (const NvDlaPatternSet::Match& match : matches) {
+      if (isa<Conv>(match.operators[0])) {
+        foldIntoProducer(pCG, match);
+      } else {
+        foldIntoConsumer(pCG, match);
+      }
+      ++numOfFolded;
+    }
+  }
+
+  if (numOfFolded != 0) {
+    std::cout << "NvDlaFoldShufflePass: folded " << numOfFolded << " Shuffle into Conv weights\n";
+    ret |= Pass::kModuleChanged;
+    pCG.topologicalSort();
+  }
+
+  return ret;
+}
+
+void NvDlaFoldShufflePass::foldIntoProducer(ComputeGraph& pCG, const NvDlaPatternMatch& match)
+{
+  auto* conv    = dyn_cast<Conv>(match.operators[0]);
+  auto* shuffle = dyn_cast<NvDlaShuffle>(match.operators[1]);
+
+  Tensor*      input_tensor       = conv->getInput(0);
+  FloatTensor* weight             = getConstant(conv->getInput(1));
+  FloatTensor* bias               = (conv->getNumOfInputs() < 3 ? nullptr : getConstant(conv->getInput(2)));
+  Tensor*      conv_out_tensor    = conv->getOutput(0);
+  Tensor*      shuffle_out_tensor = shuffle->getOutput(0);
+
+  // The filter j of the new weight is the filter perm[j] of the old one, so
+  // the Conv computes the shuffled channels directly.
+  const Permutation perm       = getPermutation(*shuffle);
+  const std::string suffix     = "__shuffle_" + std::to_string(tensorIdx++);
+  const std::size_t filterSize = weight->getValues().size() / perm.size();
+
+  FloatTensor* new_weight = addConstant(pCG, *weight, weight->getName() + suffix);
+  FloatTensor* new_bias   = (bias != nullptr ? addConstant(pCG, *bias, bias->getName() + suffix) : nullptr);
+  for (std::size_t j = 0; j < perm.size(); ++j) {
+    const auto first = weight->getValues().begin() + perm[j] * filterSize;
+    new_weight->getValues().insert(new_weight->getValues().end(), first, first + filterSize);
+    if (new_bias != nullptr) {
+      new_bias->getValues().push_back(bias->getValues()[perm[j]]);
+    }
+  }
+
+  // The current ONNC IR graph status
+  // ================================
+  //
+  //       |              |         |
+  //  input_tensor     weight    (bias)
+  //           \          |      /
+  //                 (conv)
+  //                    |
+  //             conv_out_tensor
+  //                    |
+  //                (shuffle)
+  //                    |
+  //           shuffle_out_tensor
+  //                    |
+
+  conv->removeAllInputs();
+  conv->removeAllOutputs();
+  shuffle->removeAllInputs();
+  shuffle->removeAllOutputs();
+  pCG.erase(*shuffle);
+  pCG.erase(*conv_out_tensor);
+
+  conv->addInput(*input_tensor);
+  conv->addInput(*new_weight);
+  if (new_bias != nullptr) {
+    conv->addInput(*new_bias);
+  }
+  conv->addOutput(*shuffle_out_tensor);
+
+  eraseIfUnused(pCG, *weight);
+  if (bias != nullptr) {
+    eraseIfUnused(pCG, *bias);
+  }
+
+  // The current ONNC IR graph status
+  // ================================
+  //
+  //       |              |            |
+  //  input_tensor   new_weight    (new_bias)
+  //           \          |       /
+  //                 (conv)
+  //                    |
+  //           shuffle_out_tensor
+  //                    |
+}
+
+void NvDlaFoldShufflePass::foldIntoConsumer(ComputeGraph& pCG, const NvDlaPatternMatch& match)
+{
+  auto* shuffle = dyn_cast<NvDlaShuffle>(match.operators[0]);
+  auto* conv    = dyn_cast<Conv>(match.operators[1]);
+
+  Tensor*      input_tensor       = shuffle->getInput(0);
+  Tensor*      shuffle_out_tensor = shuffle->getOutput(0);
+  FloatTensor* weight             = getConstant(conv->getInput(1));
+  Tensor*      bias               = (conv->getNumOfInputs() < 3 ? nullptr : conv->getInput(2));
+
+  // The Conv reads channel perm[j] where it read channel j, so the weight of
+  // input channel j moves to perm[j] within the group of its filter.
+  const Permutation perm            = getPermutation(*shuffle);
+  const std::string suffix          = "__shuffle_" + std::to_string(tensorIdx++);
+  const std::size_t numFilters      = weight->dimension(0);
+  const std::size_t groupSize       = weight->dimension(1);
+  const std::size_t filtersPerGroup = numFilters / conv->getGroup().value();
+  const std::size_t kernelSize      = weight->getValues().size() / (numFilters * groupSize);
+
+  FloatTensor* new_weight = addConstant(pCG, *weight, weight->getName() + suffix);
+  new_weight->getValues().resize(weight->getValues().size());
+  for (std::size_t filter = 0; filter < numFilters; ++filter) {
+    const std::size_t base = (filter / filtersPerGroup) * groupSize;
+    for (std::size_t channel = 0; channel < groupSize; ++channel) {
+      const std::size_t moved = perm[base + channel] - base;
+      const auto        first = weight->getValues().begin() + (filter * groupSize + channel) * kernelSize;
+      std::copy(first, first + kernelSize,
+                new_weight->getValues().begin() + (filter * groupSize + moved) * kernelSize);
+    }
+  }
+
+  // The current ONNC IR graph status
+  // ================================
+  //
+  //       |
+  //  input_tensor
+  //       |
+  //   (shuffle)
+  //       |
+  // shuffle_out_tensor  weight  (bias)
+  //           \           |     /
+  //                 (conv)
+  //                    |
+
+  shuffle->removeAllInputs();
+  shuffle->removeAllOutputs();
+  conv->removeAllInputs();
+  pCG.erase(*shuffle);
+  pCG.erase(*shuffle_out_tensor);
+
+  conv->addInput(*input_tensor);
+  conv->addInput(*new_weight);
+  if (bias != nullptr) {
+    conv->addInput(*bias);
+  }
+
+  eraseIfUnused(pCG, *weight);
+
+  // The current ONNC IR graph status
+  // ================================
+  //
+  //       |
+  //  input_tensor  new_weight  (bias)
+  //           \        |       /
+  //                 (conv)
+  //                    |
+}
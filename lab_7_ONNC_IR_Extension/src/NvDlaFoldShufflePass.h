@@ -0,0 +1,50 @@
+//===- NvDlaFoldShufflePass.h ---------------------------------------------===//
+//
+//                             The ONNC Project
+//
+// See LICENSE.TXT for details.
+//
+//===----------------------------------------------------------------------===//
+#ifndef NVDLA_FOLD_SHUFFLE_PASS_H
+#define NVDLA_FOLD_SHUFFLE_PASS_H
+
+#include "NvDlaPattern.h"
+
+#include <onnc/Core/CustomPass.h>
+
+namespace onnc {
+namespace foonvdla {
+
+/** \class NvDlaFoldShufflePass
+ *  \brief Fold a Shuffle into the weights of the Conv before or after it.
+ *
+ *  A Shuffle only permutes channels. If it is the only user of a Conv, the
+ *  Conv filters are permuted instead; if a Conv is its only user, the input
+ *  channels of that Conv's filters are. Either way no RUBIK operation is left.
+ *  A grouped Conv is folded only if the permutation keeps every channel in
+ *  its group.
+ */
+class NvDlaFoldShufflePass : public CustomPass<NvDlaFoldShufflePass>
+{
+public:
+  NvDlaFoldShufflePass();
+
+  ReturnType runOnModule(Module& pModule) override;
+  ReturnType runOnComputeGraph(ComputeGraph& pCG) override;
+
+private:
+  /// Permute the filters of the Conv producing the Shuffle input.
+  void foldIntoProducer(ComputeGraph& pCG, const NvDlaPatternMatch& match);
+
+  /// Permute the filter input channels of the Conv reading the Shuffle output.
+  void foldIntoConsumer(ComputeGraph& pCG, const NvDlaPatternMatch& match);
+
+  NvDlaPatternSet m_Patterns;
+
+  static unsigned tensorIdx;
+};
+
+} // namespace foonvdla
+} // namespace onnc
+
+#endif
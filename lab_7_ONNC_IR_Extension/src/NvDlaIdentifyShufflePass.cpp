@@ -17,9 +17,107 @@
 using namespace onnc;
 using namespace foonvdla;
 
+namespace {
+
+#define SHUFFLE_ASSERT(cond) if (! (cond)) return false;
+
+bool isSplitReshape(const ComputeOperator& op)
+{
+  const Reshape& reshape1 = *dyn_cast<Reshape>(&op);
+
+  SHUFFLE_ASSERT( reshape1.getNumOfOutputs() == 1 );
+
+  // The Reshape attribute must satisfy certain constraints.
+  // The input dimension must be 4, and this Reshape splits the second dimension into two,
+  // thus causing the output dimension to be 5.
+  // e.g. input:  1x12x5x6, shape: [1,3,4,5,6]
+  //      output: 1x3x4x5x6
+  SHUFFLE_ASSERT( reshape1.getInput(0)->getNumOfDimensions() == 4 );
+  SHUFFLE_ASSERT( reshape1.getInput(1)->getNumOfDimensions() == 1 ); // shape tensor must be array
+
+  const auto& reshape1_shape = static_cast<const Int64Tensor*>(reshape1.getInput(1))->getValues();
+  SHUFFLE_ASSERT( reshape1_shape.size() == 5 );
+  SHUFFLE_ASSERT( reshape1.getInput(0)->dimension(1) == reshape1_shape[1] * reshape1_shape[2] );
+  SHUFFLE_ASSERT( reshape1.getInput(0)->dimension(2) == reshape1_shape[3] &&
+                  reshape1.getInput(0)->dimension(3) == reshape1_shape[4]);
+
+  return true;
+}
+
+bool isSwapTranspose(const ComputeOperator& op)
+{
+  const Transpose& transpose = *dyn_cast<Transpose>(&op);
+
+  SHUFFLE_ASSERT( transpose.getNumOfOutputs() == 1 );
+
+  // the attribute of Tranpose, perm, must be [0, 2, 1, 3, 4], ie. swap the 1st and 2nd dimensions.
+  // e.g. input:  1x3x4x5x6
+  //      output: 1x4x3x5x6
+  SHUFFLE_ASSERT( transpose.getInput(0)->getNumOfDimensions() == 5 );
+  SHUFFLE_ASSERT( transpose.getPerm().at(0) == 0 &&
+                  transpose.getPerm().at(1) == 2 &&
+                  transpose.getPerm().at(2) == 1 &&
+                  transpose.getPerm().at(3) == 3 &&
+                  transpose.getPerm().at(4) == 4);
+
+  return true;
+}
+
+bool isMergeReshape(const ComputeOperator& op)
+{
+  const Reshape& reshape2 = *dyn_cast<Reshape>(&op);
+
+  // The Reshape attribute must satisfy certain constraints.
+  // The input dimension must be 5, and this Reshape merges the 2nd and 3rd dimension into one,
+  // thus causing the output dimension to be 4.
+  // e.g. input: 1x4x3x5x6, shape: [1,12,5,6]
+  // output: 1x12x5x6
+  SHUFFLE_ASSERT( reshape2.getInput(0)->getNumOfDimensions() == 5 );
+  SHUFFLE_ASSERT( reshape2.getInput(1)->getNumOfDimensions() == 1 ); // shape tensor must be array
+
+  const auto& reshape2_shape = static_cast<const Int64Tensor*>(reshape2.getInput(1))->getValues();
+  SHUFFLE_ASSERT( reshape2_shape.size() == 4 );
+  SHUFFLE_ASSERT( reshape2.getInput(0)->dimension(1) * reshape2.getInput(0)->dimension(2) ==
+                  reshape2_shape[1] );
+  SHUFFLE_ASSERT( reshape2.getInput(0)->dimension(3) == reshape2_shape[2] &&
+                  reshape2.getInput(0)->dimension(4) == reshape2_shape[3]);
+
+  return true;
+}
+
+#undef SHUFFLE_ASSERT
+
+} // namespace
+
 //===----------------------------------------------------------------------===//
 // NvDlaIdentifyShufflePass
 //===----------------------------------------------------------------------===//
+NvDlaIdentifyShufflePass::NvDlaIdentifyShufflePass()
+{
+  // We are going to detect the following pattern.
+  //
+  //       |
+  //  input_tensor
+  //           \ 
+  //          (reshape1)
+  //              |
+  //     reshape1_out_tensor
+  //              |      // This tensor must have only one user.
+  //         (transpose)
+  //              |
+  //       transpose_out
+  //               \     // This tensor must have only one user.
+  //             (reshape2)
+  //                  |
+  //            output_tensor
+  //                  |
+  //
+  m_Patterns.add(NvDlaPattern("Shuffle")
+                   .op<Reshape>().singleUse().where(isSplitReshape)
+                   .op<Transpose>().singleUse().where(isSwapTranspose)
+                   .op<Reshape>().where(isMergeReshape));
+}
+
 Pass::ReturnType NvDlaIdentifyShufflePass::runOnModule(Module& pModule)
 {
   Pass::ReturnType ret = kModuleNoChanged;
@@ -41,30 +139,23 @@ Pass::ReturnType NvDlaIdentifyShufflePass::runOnComputeGraph(ComputeGraph& pCG)
   // Find out all Reshape-Transpose-Reshape patterns in the model graph.
   //---------------------------------------------------------------------
   
-  std::vector<Reshape*> reshapes;
-  for (auto& op : pCG) {
-    if (Reshape* reshape1 = dyn_cast<Reshape>(&op)) {
-      if (is_shuffle(reshape1)) { // A channel-shuffle pattern is detected.
-        // Save the first node of this pattern into a queue.
-        // We will replace this pattern by a single Shuffle IR later on.
-        reshapes.push_back(reshape1);
-
-        // Since a node replacement will happen in the model, the model graph
-        // will be changed and thus this function should return kModuleChanged.
-        ret |= Pass::kModuleChanged;
-      }
-    }
+  const NvDlaPatternSet::MatchList matches = m_Patterns.match(pCG);
+  if (!matches.empty()) {
+    // Since a node replacement will happen in the model, the model graph
+    // will be changed and thus this function should return kModuleChanged.
+    ret |= Pass::kModuleChanged;
   }
 
   //---------------------------------------------------------------------------
   // Replace every Reshape-Transpose-Reshape pattern with a single Shuffle IR.
   //---------------------------------------------------------------------------
   
-  for (Reshape* reshape1 : reshapes) {
+  for (const NvDlaPatternSet::Match& match : matches) {
 
-    // Derive the Tranpose and the second Reshape.
-    auto* transpose  = dyn_cast<Transpose>(reshape1->getOutput(0)->getUses()[0].getUser());
-    auto* reshape2 = dyn_cast<Reshape>(transpose->getOutput(0)->getUses()[0].getUser());
+    // Derive the Reshapes and the Tranpose.
+    auto* reshape1  = dyn_cast<Reshape>(match.operators[0]);
+    auto* transpose = dyn_cast<Transpose>(match.operators[1]);
+    auto* reshape2  = dyn_cast<Reshape>(match.operators[2]);
 
     Tensor* input_tensor = reshape1->getInput(0);
     Tensor* shape1_tensor = reshape1->getInput(1);
@@ -192,99 +283,3 @@ Pass::ReturnType NvDlaIdentifyShufflePass::runOnComputeGraph(ComputeGraph& pCG)
 
   return ret;
 }
-
-bool NvDlaIdentifyShufflePass::is_shuffle(Reshape* reshape1)
-{
-  // We are going to detect the following pattern.
-  //
-  //       |
-  //  input_tensor
-  //           \ 
-  //          (reshape1)
-  //              |
-  //     reshape1_out_tensor
-  //              |      // This tensor must have only one user.
-  //         (transpose)
-  //              |
-  //       transpose_out
-  //               \     // This tensor must have only one user.
-  //             (reshape2)
-  //                  |
-  //            output_tensor
-  //                  |
-  //
-  
-#define SHUFFLE_ASSERT(cond) if (! (cond)) return false;
-
-  //--------------------------
-  // Check the first Reshape.
-  //--------------------------
-
-  SHUFFLE_ASSERT( reshape1->getNumOfOutputs() == 1 );
-
-  // the output tensor of the Reshape has only one user.
-  SHUFFLE_ASSERT( reshape1->getOutput(0)->getUses().size() == 1 );
-
-  // The Reshape attribute must satisfy certain constraints.
-  // The input dimension must be 4, and this Reshape splits the second dimension into two,
-  // thus causing the output dimension to be 5.
-  // e.g. input:  1x12x5x6, shape: [1,3,4,5,6]
-  //      output: 1x3x4x5x6
-  SHUFFLE_ASSERT( reshape1->getInput(0)->getNumOfDimensions() == 4 );
-  SHUFFLE_ASSERT( reshape1->getInput(1)->getNumOfDimensions() == 1 ); // shape tensor must be array
-
-  const auto& reshape1_shape = static_cast<Int64Tensor*>(reshape1->getInput(1))->getValues();
-  SHUFFLE_ASSERT( reshape1_shape.size() == 5 );
-  SHUFFLE_ASSERT( reshape1->getInput(0)->dimension(1) == reshape1_shape[1] * reshape1_shape[2] );
-  SHUFFLE_ASSERT( reshape1->getInput(0)->dimension(2) == reshape1_shape[3] &&
-                  reshape1->getInput(0)->dimension(3) == reshape1_shape[4]);
-  
-  //-----------------------------
-  // Check the middle Transpose.
-  //-----------------------------
-
-  // the output tensor of the first Reshape has the user to be a Transpose.
-  Transpose* transpose = dyn_cast<Transpose>(reshape1->getOutput(0)->getUses()[0].getUser());
-  SHUFFLE_ASSERT( transpose );
-
-  // the output tensor of the Transpose has only one user.
-  SHUFFLE_ASSERT( transpose->getNumOfOutputs() == 1 );
-  SHUFFLE_ASSERT( transpose->getOutput(0)->getUses().size() == 1 );
-
-  // the attribute of Tranpose, perm, must be [0, 2, 1, 3, 4], ie. swap the 1st and 2nd dimensions.
-  // e.g. input:  1x3x4x5x6
-  //      output: 1x4x3x5x6
-  SHUFFLE_ASSERT( transpose->getInput(0)->getNumOfDimensions() == 5 );
-  SHUFFLE_ASSERT( transpose->getPerm().at(0) == 0 &&
-                  transpose->getPerm().at(1) == 2 &&
-                  transpose->getPerm().at(2) == 1 &&
-                  transpose->getPerm().at(3) == 3 &&
-                  transpose->getPerm().at(4) == 4);
-
-  //-----------------------------
-  // Check the last Reshape.
-  //-----------------------------
-
-  // the output tensor of the middle Transpose has the user to be a Reshape.
-  Reshape* reshape2 = dyn_cast<Reshape>(transpose->getOutput(0)->getUses()[0].getUser());
-  SHUFFLE_ASSERT( reshape2 );
-
-  // The Reshape attribute must satisfy certain constraints.
-  // The input dimension must be 5, and this Reshape merges the 2nd and 3rd dimension into one,
-  // thus causing the output dimension to be 4.
-  // e.g. input: 1x4x3x5x6, shape: [1,12,5,6]
-  // output: 1x12x5x6
-  SHUFFLE_ASSERT( reshape2->getInput(0)->getNumOfDimensions() == 5 );
-  SHUFFLE_ASSERT( reshape2->getInput(1)->getNumOfDimensions() == 1 ); // shape tensor must be array
-
-  const auto& reshape2_shape = static_cast<Int64Tensor*>(reshape2->getInput(1))->getValues();
-  SHUFFLE_ASSERT( reshape2_shape.size() == 4 );
-  SHUFFLE_ASSERT( reshape2->getInput(0)->dimension(1) * reshape2->getInput(0)->dimension(2) ==
-                  reshape2_shape[1] );
-  SHUFFLE_ASSERT( reshape2->getInput(0)->dimension(3) == reshape2_shape[2] &&
-                  reshape2->getInput(0)->dimension(4) == reshape2_shape[3]);
-
-#undef SHUFFLE_ASSERT
-
-  return true;
-}
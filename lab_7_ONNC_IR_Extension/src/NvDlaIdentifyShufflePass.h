@@ -9,6 +9,7 @@
 #define NVDLA_IDENTIFY_SHUFFLE_PASS_H
 
 #include "NvDlaMeta.h"
+#include "NvDlaPattern.h"
 
 #include <onnc/Core/CustomPass.h>
 
@@ -18,13 +19,13 @@ namespace foonvdla {
 class NvDlaIdentifyShufflePass : public CustomPass<NvDlaIdentifyShufflePass>
 {
 public:
-  NvDlaIdentifyShufflePass() = default;
+  NvDlaIdentifyShufflePass();
 
   ReturnType runOnModule(Module& pModule) override;
   ReturnType runOnComputeGraph(ComputeGraph& pCG) override;
   
 private:
-  bool is_shuffle(Reshape* reshape1);
+  NvDlaPatternSet m_Patterns;
 };
 
 } // namespace foonvdla
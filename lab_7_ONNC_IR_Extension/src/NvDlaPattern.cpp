@@ -0,0 +1,183 @@
+//===- NvDlaPattern.cpp ---------------------------------------------------===//
+//
+//                             The ONNC Project
+//
+// See LICENSE.TXT for details.
+//
+//===----------------------------------------------------------------------===//
+#include "NvDlaPattern.h"
+
+#include "NvDlaUtil.h"
+
+#include <algorithm>
+#include <cassert>
+#include <unordered_set>
+
+namespace onnc {
+namespace foonvdla {
+
+//===----------------------------------------------------------------------===//
+// NvDlaPattern
+//===----------------------------------------------------------------------===//
+NvDlaPattern::NvDlaPattern(std::string name)
+  : m_Name{std::move(name)}
+{}
+
+NvDlaPattern& NvDlaPattern::op(Kind kind)
+{
+  const unsigned parent = (m_Nodes.empty() ? 0 : m_Nodes.size() - 1);
+  m_Nodes.push_back(Node{kind, parent, 0, false, false, {}});
+  return *this;
+}
+
+NvDlaPattern& NvDlaPattern::from(unsigned node, unsigned output)
+{
+  assert(1 < m_Nodes.size() && node + 1 < m_Nodes.size() && "must be an earlier node");
+  m_Nodes.back().parent = node;
+  m_Nodes.back().output = output;
+  return *this;
+}
+
+NvDlaPattern& NvDlaPattern::singleUse()
+{
+  assert(!m_Nodes.empty());
+  m_Nodes.back().isSingleUse = true;
+  return *this;
+}
+
+NvDlaPattern& NvDlaPattern::hasConstantInput()
+{
+  assert(!m_Nodes.empty());
+  m_Nodes.back().hasConstantInput = true;
+  return *this;
+}
+
+NvDlaPattern& NvDlaPattern::where(Predicate predicate)
+{
+  assert(!m_Nodes.empty());
+  m_Nodes.back().predicates.emplace_back(std::move(predicate));
+  return *this;
+}
+
+NvDlaPattern::Kind NvDlaPattern::getRootKind() const
+{
+  assert(!m_Nodes.empty());
+  return m_Nodes.front().kind;
+}
+
+bool NvDlaPattern::match(ComputeOperator& root, Operators& operators) const
+{
+  if (m_Nodes.empty() || !isMatched(m_Nodes.front(), root)) {
+    return false;
+  }
+
+  operators.assign(1, &root);
+  return matchFrom(1, operators);
+}
+
+bool NvDlaPattern::isMatched(const Node& node, const ComputeOperator& op) const
+{
+  if (op.getID() != node.kind) {
+    return false;
+  }
+
+  if (node.isSingleUse && (op.getNumOfOutputs() == 0 || op.getOutput(0)->getUses().size() != 1)) {
+    return false;
+  }
+
+  if (node.hasConstantInput) {
+    bool hasConstant = false;
+    for (unsigned idx = 0; idx < op.getNumOfInputs() && !hasConstant; ++idx) {
+      const Tensor* input = dynamic_cast<const Tensor*>(op.getInput(idx));
+      hasConstant         = (input != nullptr && isConstant(*input));
+    }
+    if (!hasConstant) {
+      return false;
+    }
+  }
+
+  return std::all_of(node.predicates.begin(), node.predicates.end(),
+                     [&op](const Predicate& predicate) { return predicate(op); });
+}
+
+bool NvDlaPattern::matchFrom(unsigned idx, Operators& operators) const
+{
+  if (idx == m_Nodes.size()) {
+    return true;
+  }
+
+  const Node&      node   = m_Nodes[idx];
+  ComputeOperator* parent = operators[node.parent];
+  if (parent->getNumOfOutputs() <= node.output) {
+    return false;
+  }
+
+  // try every user, a later node may only match with one of them
+  for (const auto& use : parent->getOutput(node.output)->getUses()) {
+    ComputeOperator* user = use.getUser();
+    if (std::find(operators.begin(), operators.end(), user) != operators.end() || !isMatched(node, *user)) {
+      continue;
+    }
+
+    operators.emplace_back(user);
+    if (matchFrom(idx + 1, operators)) {
+      return true;
+    }
+    operators.pop_back();
+  }
+  return false;
+}
+
+//===----------------------------------------------------------------------===//
+// NvDlaPatternSet
+//===----------------------------------------------------------------------===//
+NvDlaPatternSet& NvDlaPatternSet::add(NvDlaPattern pattern)
+{
+  m_PatternsByRoot[pattern.getRootKind()].emplace_back(m_Patterns.size());
+  m_Patterns.emplace_back(std::move(pattern));
+  return *this;
+}
+
+NvDlaPatternSet::MatchList NvDlaPatternSet::match(ComputeOperator& root) const
+{
+  MatchList  matches;
+  const auto found = m_PatternsByRoot.find(root.getID());
+  if (found == m_PatternsByRoot.end()) {
+    return matches;
+  }
+
+  for (unsigned idx : found->second) {
+    Match match{&m_Patterns[idx], {}};
+    if (m_Patterns[idx].match(root, match.operators)) {
+      matches.emplace_back(std::move(match));
+    }
+  }
+  return matches;
+}
+
+NvDlaPatternSet::MatchList NvDlaPatternSet::match(ComputeGraph& pCG) const
+{
+  MatchList                            matches;
+  std::unordered_set<ComputeOperator*> claimed;
+  for (ComputeOperator& op : pCG) {
+    if (claimed.count(&op) != 0) {
+      continue;
+    }
+
+    for (Match& match : match(op)) {
+      const bool isOverlapped = std::any_of(match.operators.begin(), match.operators.end(),
+                                            [&claimed](ComputeOperator* matched) { return claimed.count(matched) != 0; });
+      if (isOverlapped) {
+        continue;
+      }
+
+      claimed.insert(match.operators.begin(), match.operators.end());
+      matches.emplace_back(std::move(match));
+      break;
+    }
+  }
+  return matches;
+}
+
+} // namespace foonvdla
+} // namespace onnc
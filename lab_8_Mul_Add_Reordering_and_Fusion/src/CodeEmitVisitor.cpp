@@ -11,6 +11,7 @@
 #include "Compute/NvDlaAddMulRelu.h"
 #include <onnc/IR/Compute/Initializer.h>
 #include <onnc/IR/Compute/InputOperator.h>
+#include <onnc/IR/Compute/Log.h>
 #include <onnc/IR/Compute/OutputOperator.h>
 
 #include "NvDlaUtil.h"
@@ -267,6 +268,114 @@ private:
   dla_data_cube& cube_;
 };
 
+bool operator==(std::underlying_type<NvDlaMemType>::type lhs, NvDlaMemType rhs)
+{
+  return lhs == static_cast<std::underlying_type<NvDlaMemType>::type>(rhs);
+}
+
+/// Bytes [begin, end) of a memory list entry.
+struct NvDlaMemRegion
+{
+  MemoryListEntryId        memoryId;
+  NvDlaBackendMeta::Offset begin;
+  NvDlaBackendMeta::Offset end;
+};
+
+struct NvDlaMemAccess
+{
+  std::vector<NvDlaMemRegion> reads;
+  std::vector<NvDlaMemRegion> writes;
+};
+
+void addMemRegion(std::vector<NvDlaMemRegion>& regions, const NvDlaBackendMeta& meta, std::int16_t address,
+                  std::uint32_t size)
+{
+  // address 0 is the dummy entry which unused (zero-filled) cubes refer to
+  if (address <= 0) {
+    return;
+  }
+
+  const NvDlaBackendMeta::AddressListEntry& entry = meta.m_AddressListEntries[address];
+  regions.push_back(NvDlaMemRegion{entry.mem_id, entry.offset, entry.offset + (size != 0 ? size : entry.size)});
+}
+
+void addMemRegion(std::vector<NvDlaMemRegion>& regions, const NvDlaBackendMeta& meta, const dla_data_cube& cube)
+{
+  // cubes passed between engines on the fly do not touch memory
+  if (cube.type == NvDlaMemType::hw) {
+    return;
+  }
+
+  addMemRegion(regions, meta, cube.address, cube.size);
+}
+
+/// Memory read and written by an operation, found by its surface descriptor.
+NvDlaMemAccess getMemAccess(const NvDlaDlaOperation& operation, const NvDlaBackendMeta& meta)
+{
+  NvDlaMemAccess access;
+  switch (operation.op_dep.op_type) {
+  case DLA_OP_BDMA: {
+    const dla_bdma_surface_desc& surface = operation.op_surf.bdma_surface;
+    for (std::uint16_t idx = 0; idx < surface.num_transfers; ++idx) {
+      const dla_bdma_transfer_desc& transfer = surface.transfers[idx];
+      addMemRegion(access.reads, meta, transfer.source_address, 0);
+      addMemRegion(access.writes, meta, transfer.destination_address, 0);
+    }
+  } break;
+  case DLA_OP_CONV: {
+    const dla_conv_surface_desc& surface = operation.op_surf.conv_surface;
+    addMemRegion(access.reads, meta, surface.weight_data);
+    addMemRegion(access.reads, meta, surface.wmb_data);
+    addMemRegion(access.reads, meta, surface.wgs_data);
+    addMemRegion(access.reads, meta, surface.src_data);
+    addMemRegion(access.writes, meta, surface.dst_data);
+  } break;
+  case DLA_OP_SDP: {
+    const dla_sdp_surface_desc& surface = operation.op_surf.sdp_surface;
+    addMemRegion(access.reads, meta, surface.src_data);
+    addMemRegion(access.reads, meta, surface.x1_data);
+    addMemRegion(access.reads, meta, surface.x2_data);
+    addMemRegion(access.reads, meta, surface.y_data);
+    addMemRegion(access.writes, meta, surface.dst_data);
+  } break;
+  case DLA_OP_PDP:
+    addMemRegion(access.reads, meta, operation.op_surf.pdp_surface.src_data);
+    addMemRegion(access.writes, meta, operation.op_surf.pdp_surface.dst_data);
+    break;
+  case DLA_OP_CDP:
+    addMemRegion(access.reads, meta, operation.op_surf.cdp_surface.src_data);
+    addMemRegion(access.writes, meta, operation.op_surf.cdp_surface.dst_data);
+    break;
+  case DLA_OP_RUBIK:
+    addMemRegion(access.reads, meta, operation.op_surf.rubik_surface.src_data);
+    addMemRegion(access.writes, meta, operation.op_surf.rubik_surface.dst_data);
+    break;
+  default:
+    assert(false && "meet unknown operation type");
+    break;
+  }
+  return access;
+}
+
+bool isOverlapped(const std::vector<NvDlaMemRegion>& lhs, const std::vector<NvDlaMemRegion>& rhs)
+{
+  for (const NvDlaMemRegion& left : lhs) {
+    for (const NvDlaMemRegion& right : rhs) {
+      if (left.memoryId == right.memoryId && left.begin < right.end && right.begin < left.end) {
+        return true;
+      }
+    }
+  }
+  return false;
+}
+
+/// Read after write, write after read or write after write.
+bool isConflicting(const NvDlaMemAccess& before, const NvDlaMemAccess& after)
+{
+  return isOverlapped(before.writes, after.reads) || isOverlapped(before.reads, after.writes) ||
+         isOverlapped(before.writes, after.writes);
+}
+
 } // namespace internal
 
 using namespace onnc;
@@ -305,6 +414,44 @@ void CodeEmitVisitor::visit(const Conv& pConv)
 {
 }
 
+void CodeEmitVisitor::visit(const Log& pOp)
+{
+  printf("visit(Log) is called\n");
+
+  // Get tensor attributes.
+  const Tensor& input  = *(pOp.getInput(0));
+  const Tensor& output = *(pOp.getOutput(0));
+
+  NvDlaEmuOperation* operation = new NvDlaEmuOperation();
+
+  struct emu_log_op_desc& desc = (struct emu_log_op_desc&)(operation->op_desc);
+  desc.common.op_type          = NVDLA_EMU_OP_LOG;
+
+  struct emu_log_buffer_descs& surface = (struct emu_log_buffer_descs&)(operation->op_buf);
+
+  const NvDlaCubeInfo inputCubeInfo  = makeCubeInfo(*this, NVDLA_CUBE_FEATURE, input);
+  surface.src_data.addressIndex      = issueEmuAddr(input);
+  surface.src_data.size              = m_pMeta.getMemoryListEntrySize(input);
+  surface.src_data.format            = PRECISION_FP16;
+  surface.src_data.width             = inputCubeInfo.dim_w;
+  surface.src_data.height            = inputCubeInfo.dim_h;
+  surface.src_data.channel           = inputCubeInfo.dim_c;
+  surface.src_data.line_stride       = inputCubeInfo.stride_line;
+  surface.src_data.surf_stride       = inputCubeInfo.stride_surface;
+
+  const NvDlaCubeInfo outputCubeInfo = makeCubeInfo(*this, NVDLA_CUBE_FEATURE, output);
+  surface.dst_data.addressIndex      = issueEmuAddr(output);
+  surface.dst_data.size              = m_pMeta.getMemoryListEntrySize(output);
+  surface.dst_data.format            = PRECISION_FP16;
+  surface.dst_data.width             = outputCubeInfo.dim_w;
+  surface.dst_data.height            = outputCubeInfo.dim_h;
+  surface.dst_data.channel           = outputCubeInfo.dim_c;
+  surface.dst_data.line_stride       = outputCubeInfo.stride_line;
+  surface.dst_data.surf_stride       = outputCubeInfo.stride_surface;
+
+  issueEmuOp(operation);
+}
+
 void CodeEmitVisitor::visit(const NvDlaAddMulRelu& pOp)
 {
   printf("visit(NvDlaAddMulRelu) is called\n");
@@ -484,20 +631,11 @@ MemoryListEntryId CodeEmitVisitor::packFeature(const Tensor& tensor, const NvDla
   return 0;
 }
 
-AddressListEntryId CodeEmitVisitor::issueEmuAddr(MemoryListEntryId mid)
+AddressListEntryId CodeEmitVisitor::issueEmuAddr(const Tensor& tensor)
 {
-  AddressListEntryId aid = m_pMeta.m_AddressListEntries.size();
-
-  ILoadable::AddressListEntry ale;
-  ILoadable::MemoryListEntry  mle = m_pMeta.getMemoryListEntry(mid);
-
-  ale.size   = 0;
-  ale.offset = 0;
-  ale.mem_id = mid;
-  ale.id     = aid;
-
-  m_pMeta.m_AddressListEntries.push_back(ale);
-  return aid;
+  // tensors packed into a shared entry start at their own offset
+  return m_pMeta.acquireMemory(m_pMeta.getMemoryListEntryId(tensor), m_pMeta.getMemoryOffset(tensor),
+                               m_pMeta.getMemoryListEntrySize(tensor));
 }
 
 void CodeEmitVisitor::issueEmuOp(NvDlaEmuOperation* op)
@@ -516,14 +654,16 @@ AddressListEntryId CodeEmitVisitor::issueDlaAddr(const Tensor& tensor, const NvD
   const offset_type h_offset     = hOffset * cube.stride_line;
   const offset_type memoryOffset = (channelOffset * (cube.dim_h * cube.dim_w * ELEMENT_SIZE)) + h_offset;
 
-  return m_pMeta.acquireMemory(m_pMeta.getMemoryListEntryId(tensor), memoryOffset);
+  // tensors packed into a shared entry start at their own offset
+  return m_pMeta.acquireMemory(m_pMeta.getMemoryListEntryId(tensor), m_pMeta.getMemoryOffset(tensor) + memoryOffset,
+                               m_pMeta.getMemoryListEntrySize(tensor));
 }
 
 AddressListEntryId CodeEmitVisitor::issueDlaAddr(const Tensor& tensor, const NvDlaCubeInfo& cube)
 {
   const MemoryListEntryId memoryId = m_pMeta.getMemoryListEntryId(tensor);
 
-  return m_pMeta.acquireMemory(memoryId, 0);
+  return m_pMeta.acquireMemory(memoryId, m_pMeta.getMemoryOffset(tensor), m_pMeta.getMemoryListEntrySize(tensor));
 }
 
 AddressListEntryId CodeEmitVisitor::issueSDPOperand(const Tensor& tensor, const NvDlaCubeInfo& cube,
@@ -545,32 +685,68 @@ AddressListEntryId CodeEmitVisitor::issueDlaAddr(MemoryListEntryId memoryId, con
   return m_pMeta.acquireMemory(memoryId, 0);
 }
 
+bool CodeEmitVisitor::addDataDependencies(NvDlaDlaOperation& op)
+{
+  const int            opType = op.op_dep.op_type;
+  const NvDlaMemAccess access = getMemAccess(op, m_pMeta);
+
+  // Engines run their operations in order, so only the latest conflicting
+  // operation of each engine needs an edge. Operations of former task
+  // entries are already done when this task starts.
+  bool              isFound[DLA_OP_NUM]     = {false};
+  bool              isConflictingWithEngine = false;
+  const std::size_t firstInTask             = m_pMeta.getFirstDlaOperationInTaskEntry();
+  for (std::size_t idx = m_pMeta.m_DLAOperationList.size(); firstInTask < idx; --idx) {
+    NvDlaDlaOperation& before     = *m_pMeta.m_DLAOperationList[idx - 1];
+    const int          beforeType = before.op_dep.op_type;
+    if (isFound[beforeType] || !isConflicting(getMemAccess(before, m_pMeta), access)) {
+      continue;
+    }
+    isFound[beforeType] = true;
+
+    if (beforeType == opType) {
+      isConflictingWithEngine = (&before == m_pMeta.m_pDepOp[opType]);
+      continue;
+    }
+
+    // An operation signals at most one consumer per engine. If the slot is
+    // taken by an earlier operation of this engine, that one already waits
+    // for 'before', and this operation runs after it.
+    dla_consumer& consumer = before.op_dep.consumers[opType];
+    if (consumer.index < 0) {
+      consumer.index = op.op_dep.index;
+      consumer.event = DLA_EVENT_OP_COMPLETED;
+      op.op_dep.dependency_count++;
+    }
+  }
+
+  return isConflictingWithEngine;
+}
+
 void CodeEmitVisitor::issueDlaOp(NvDlaDlaOperation* op, NvDlaDlaOperation* op_fuse, NvDlaDlaOperation* op_prev)
 {
   struct dla_common_op_desc* op_desc = &(op->op_dep);
   int                        op_type = op_desc->op_type;
   op_desc->index            = m_pMeta.m_DLAOperationList.size();
+  // ROIs share the operation, NvDlaTaskSubmitPass repeats its surfaces
   op_desc->roi_index        = 0;
   op_desc->dependency_count = 0;
 
-  if (op_prev != NULL && !m_pMeta.isLastDlaOperationInTaskEntry(*op_prev)) {
-    struct dla_common_op_desc* prev_op_desc = &(op_prev->op_dep);
-    prev_op_desc->consumers[op_type].index  = op_desc->index;
-    prev_op_desc->consumers[op_type].event  = 1;
-    op_desc->dependency_count++;
-  }
+  // wait for the operations accessing the same memory
+  const bool isConflictingWithEngine = addDataDependencies(*op);
 
-  if (m_pMeta.m_pDepOp[op_type] != NULL && !m_pMeta.isLastDlaOperationInTaskEntry(*m_pMeta.m_pDepOp[op_type])) {
+  // wait for the previous operation of the same engine
+  if (m_pMeta.m_pDepOp[op_type] != NULL && m_pMeta.isInCurrentTaskEntry(*m_pMeta.m_pDepOp[op_type])) {
     struct dla_common_op_desc* dep_op_desc = &(m_pMeta.m_pDepOp[op_type]->op_dep);
-    if (m_pMeta.m_pDepOp[op_type] != op_prev) {
-      dep_op_desc->consumers[op_type].index = op_desc->index;
-      if ((op_type == DLA_OP_CONV) && (op_prev == NULL)) { // splitted convolution layers other than the first one
-        dep_op_desc->consumers[op_type].event = 3;
-      } else { // first splitted layer or other normal layers
-        dep_op_desc->consumers[op_type].event = 2;
-      }
-      op_desc->dependency_count++;
+    dep_op_desc->consumers[op_type].index  = op_desc->index;
+    if (isConflictingWithEngine) {
+      dep_op_desc->consumers[op_type].event = DLA_EVENT_OP_COMPLETED;
+    } else if ((op_type == DLA_OP_CONV) && (op_prev == NULL)) { // splitted convolution layers other than the first one
+      dep_op_desc->consumers[op_type].event = DLA_EVENT_OP_ENABLED;
+    } else { // first splitted layer or other normal layers
+      dep_op_desc->consumers[op_type].event = DLA_EVENT_OP_PROGRAMMED;
     }
+    op_desc->dependency_count++;
   }
 
   m_pMeta.m_DlaNetworkDesc.op_head[op_type] = (m_pMeta.m_DlaNetworkDesc.op_head[op_type] < 0)
@@ -594,16 +770,14 @@ void CodeEmitVisitor::issueDlaOp(NvDlaDlaOperation* op, NvDlaDlaOperation* op_fu
 
     op_desc->consumers[op_fuse_type].index = fuse_op_desc->index;
     op_desc->consumers[op_fuse_type].event = 2;
-    if (op_prev != NULL) {
-      struct dla_common_op_desc* prev_op_desc = &(op_prev->op_dep);
-      prev_op_desc->consumers[op_type].event  = 1;
-    }
     op_desc->dependency_count++;
 
-    if (m_pMeta.m_pDepOp[op_fuse_type] != NULL) {
+    const bool isFuseConflictingWithEngine = addDataDependencies(*op_fuse);
+    if (m_pMeta.m_pDepOp[op_fuse_type] != NULL && m_pMeta.isInCurrentTaskEntry(*m_pMeta.m_pDepOp[op_fuse_type])) {
       struct dla_common_op_desc* dep_op_desc     = &(m_pMeta.m_pDepOp[op_fuse_type]->op_dep);
       dep_op_desc->consumers[op_fuse_type].index = fuse_op_desc->index;
-      dep_op_desc->consumers[op_fuse_type].event = 2;
+      dep_op_desc->consumers[op_fuse_type].event =
+        (isFuseConflictingWithEngine ? DLA_EVENT_OP_COMPLETED : DLA_EVENT_OP_PROGRAMMED);
 
       fuse_op_desc->dependency_count++;
     }
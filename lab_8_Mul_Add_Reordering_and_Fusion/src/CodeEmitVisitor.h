@@ -41,6 +41,7 @@ public:
 
   /// ONNX defined operators @{
   void visit(const Conv& pConv) override;
+  void visit(const Log& pOp) override;
   void visit(const NvDlaAddMulRelu& pOp);
   /// @}
 
@@ -52,6 +53,7 @@ public:
 
   /// ONNX defined operators @{
   void visit(Conv& pConv) override;
+  void visit(Log& pOp) { visit(const_cast<const Log&>(pOp)); }
   void visit(NvDlaAddMulRelu& pOp) { visit(const_cast<const NvDlaAddMulRelu&>(pOp)); }
   /// @}
 
@@ -65,9 +67,13 @@ private:
 
   MemoryListEntryId  packFeature(const Tensor& tensor, const NvDlaCubeInfo& cube);
   void               issueEmuOp(NvDlaEmuOperation* op);
-  AddressListEntryId issueEmuAddr(MemoryListEntryId mid);
+  AddressListEntryId issueEmuAddr(const Tensor& tensor);
+  // An operation waits for the earlier operations accessing the same memory,
+  // and for the previous operation of its engine. 'op_prev' only tells if a
+  // CONV is a splitted part (nullptr) of a convolution layer.
   void               issueDlaOp(NvDlaDlaOperation* op, NvDlaDlaOperation* op_fuse, NvDlaDlaOperation* op_prev);
   void               issueDlaOp(std::unique_ptr<NvDlaDlaOperation> op);
+  bool               addDataDependencies(NvDlaDlaOperation& op);
   AddressListEntryId issueDlaAddr(const Tensor& tensor, const NvDlaCubeInfo& cube, Tensor::Dimension channelOffset,
                                   NvDlaBackendMeta::Offset hOffset);
   AddressListEntryId issueDlaAddr(const Tensor& tensor, const NvDlaCubeInfo& cube);
@@ -12,11 +12,22 @@
 #include "TargetInfo/FooNvdlaTargetMemInfo.h"
 #include "CodeEmitVisitor.h"
 #include "NvDlaMemInfoPass.h"
+#include "NvDlaTensorSchedPass.h"
+#include "NvDlaFallbackClusterPass.h"
+#include "NvDlaPartitionPass.h"
+#include "NvDlaCodeEmitPass.h"
+#include "NvDlaPerfReportPass.h"
+#include "NvDlaProfilePass.h"
 #include "NvDlaTaskSubmitPass.h"
 #include "NvDlaFileGenPass.h"
+#include "NvDlaFoldConstantPass.h"
+#include "NvDlaEliminateCommonSubexprPass.h"
+#include "NvDlaFoldBatchNormPass.h"
+#include "NvDlaFoldPadTransposePass.h"
+#include "NvDlaLowerGroupConvPass.h"
 #include "NvDlaReorderMulAddPass.h"
+#include "NvDlaFoldConvAffinePass.h"
 #include "NvDlaFuseAddMulReluPass.h"
-#include "PrintONNCIRPass.h"
 
 #include <onnc/Analysis/UpdateGraphOutputSize.h>
 #include <onnc/Analysis/NodeIRScheduler.h>
@@ -37,10 +48,21 @@
 #include <onnc/Transforms/DeadNodeElimination.h>
 #include <onnc/Transforms/RemoveTrainingNodes.h>
 #include <onnc/Transforms/TensorSel.h>
+#include <onnc/Transforms/TensorSel/Standards/BatchNormalizationLower.h>
 #include <onnc/Transforms/TensorSel/Standards/ConvLower.h>
 #include <onnc/Transforms/TensorSel/Standards/MulLower.h>
 #include <onnc/Transforms/TensorSel/Standards/AddLower.h>
+#include <onnc/Transforms/TensorSel/Standards/SubLower.h>
+#include <onnc/Transforms/TensorSel/Standards/DivLower.h>
 #include <onnc/Transforms/TensorSel/Standards/ReluLower.h>
+#include <onnc/Transforms/TensorSel/Standards/LogLower.h>
+#include <onnc/Transforms/TensorSel/Standards/PadLower.h>
+#include <onnc/Transforms/TensorSel/Standards/ReshapeLower.h>
+#include <onnc/Transforms/TensorSel/Standards/ConcatLower.h>
+#include <onnc/Transforms/TensorSel/Standards/FlattenLower.h>
+#include <onnc/Transforms/TensorSel/Standards/SqueezeLower.h>
+#include <onnc/Transforms/TensorSel/Standards/UnsqueezeLower.h>
+#include <onnc/Transforms/TensorSel/Standards/TransposeLower.h>
 
 #include <memory>
 
@@ -53,21 +75,61 @@ const Version FooNvdlaBackend::LOADABLE_VERSION = Version(1, 1, 255);
 const Version FooNvdlaBackend::BLOB_DLA_VERSION = Version(1, 3, 0);
 const Version FooNvdlaBackend::BLOB_EMU_VERSION = Version(1, 3, 0);
 
+const NvDlaMemAllocStrategy FooNvdlaBackend::MEM_ALLOC_STRATEGY = NvDlaMemAllocStrategy::kMinimumArena;
+// DRAM carve-out for weights, I/O and activations, 0 means no limit
+const NvDlaBackendMeta::Size FooNvdlaBackend::DRAM_BUDGET = 0;
+// kConcurrency overlaps engines, but only where the peak activation bytes allow
+const NvDlaSchedPolicy FooNvdlaBackend::SCHED_POLICY = NvDlaSchedPolicy::kMemory;
+// break scheduling ties by the original order, so the output is reproducible
+const bool FooNvdlaBackend::SCHED_DETERMINISTIC = true;
+// pipeline two frames with their own I/O and activations, trades latency for throughput
+const bool FooNvdlaBackend::STREAMING = false;
+// # of crops processed by one submission, weights are fetched once for all of them
+const unsigned FooNvdlaBackend::NUM_ROIS = 1;
+// split operators across the two cores of nv_full, kPipeline needs STREAMING
+const NvDlaPartitionMode FooNvdlaBackend::PARTITION_MODE = NvDlaPartitionMode::kNone;
+// sustained DRAM bandwidth assumed by the performance model
+const double FooNvdlaBackend::DRAM_BYTES_PER_CYCLE = 32.0;
+// time, peak RSS and graph size of every pass, printed after code emitting
+const bool FooNvdlaBackend::PROFILE_PASSES = false;
+// JSON copy of the pass profile, empty to print the table only
+const char* const FooNvdlaBackend::PASS_PROFILE_FILE = "pass_profile.json";
+// comma separated pass names whose input or output graph is printed, "*" for all
+const char* const FooNvdlaBackend::PRINT_BEFORE = "";
+const char* const FooNvdlaBackend::PRINT_AFTER = "";
+// comma separated operator kinds printed, e.g. "Conv,Add", empty for all
+const char* const FooNvdlaBackend::PRINT_OP_KINDS = "";
+// one file per printed graph in this directory, empty for stdout
+const char* const FooNvdlaBackend::PRINT_DIR = "";
+// kBinary snapshots are compact and can be compared by NvDlaIRSnapshot::diff
+const NvDlaIRFormat FooNvdlaBackend::PRINT_FORMAT = NvDlaIRFormat::kText;
+
 FooNvdlaBackend::FooNvdlaBackend(const TargetOptions& pOptions)
   : TargetBackend(pOptions)
   , NvDlaConstants(getConfig(::nvdla::ConfigSet::nv_full, ::nvdla::ExecutionMode::direct, false))
-  , m_pMeta(*this) { 
+  , m_pMeta(*this)
+  , m_PerfModel(*this, DRAM_BYTES_PER_CYCLE) { 
   m_pMemInfo = std::make_unique<FooNvdlaTargetMemInfo>();
+
+  m_PrintOptions.printBefore = NvDlaIRPrintOptions::split(PRINT_BEFORE);
+  m_PrintOptions.printAfter  = NvDlaIRPrintOptions::split(PRINT_AFTER);
+  m_PrintOptions.opKinds     = NvDlaIRPrintOptions::split(PRINT_OP_KINDS);
+  m_PrintOptions.directory   = PRINT_DIR;
+  m_PrintOptions.format      = PRINT_FORMAT;
 }
 
 void FooNvdlaBackend::addTensorSel(PassManager& pPM)
 {
   errs() << "FooNvdla is invoked\n";
 
+  // Start the clock of the pass profile.
+  addProfilePoint(pPM, "start");
+
   // Do ONNX graph IR optimization here.
 
   // Translate from ONNX graph IR into ONNC IR
   addStandardTensorSel(pPM, *this);
+  addProfilePoint(pPM, "StandardTensorSel");
   
   // Now ONNC IR is ready.
   // If you need to extend ONNC IR, here is the place to add your pass that
@@ -77,12 +139,18 @@ void FooNvdlaBackend::addTensorSel(PassManager& pPM)
 void FooNvdlaBackend::addOnncIrOptimization(PassManager& pPM, OptimizationOptions& options)
 {
   TargetBackend::addOnncIrOptimization(pPM, options);
+  addProfilePoint(pPM, "TargetBackend::addOnncIrOptimization");
 
-  pPM.add<PrintONNCIRPass>();
-  pPM.add<NvDlaReorderMulAddPass>();
-  pPM.add<PrintONNCIRPass>();
-  pPM.add<NvDlaFuseAddMulReluPass>();
-  pPM.add<PrintONNCIRPass>();
+  addPass<NvDlaFoldConstantPass>(pPM, "NvDlaFoldConstantPass");
+  addPass<NvDlaEliminateCommonSubexprPass>(pPM, "NvDlaEliminateCommonSubexprPass");
+  addPass<NvDlaFoldBatchNormPass>(pPM, "NvDlaFoldBatchNormPass");
+  addPass<NvDlaFoldPadTransposePass>(pPM, "NvDlaFoldPadTransposePass");
+  // Pick the cheapest CONV packing of grouped Convs, depthwise 1x1 ones go to SDP.
+  const NvDlaConstants& constants = *this;
+  addPass<NvDlaLowerGroupConvPass>(pPM, "NvDlaLowerGroupConvPass", constants, m_PerfModel);
+  addPass<NvDlaReorderMulAddPass>(pPM, "NvDlaReorderMulAddPass");
+  addPass<NvDlaFoldConvAffinePass>(pPM, "NvDlaFoldConvAffinePass");
+  addPass<NvDlaFuseAddMulReluPass>(pPM, "NvDlaFuseAddMulReluPass");
 }
 
 void FooNvdlaBackend::addTensorSched(PassManager& pPM)
@@ -90,7 +158,16 @@ void FooNvdlaBackend::addTensorSched(PassManager& pPM)
   // After method AddTensorSel, operators have been scheduled in an
   // topological order, which totally respects the data dependency.
   // However, that might not be an optimized order for certain objective.
-  // Add a scheduling optimization pass here.
+  // Reorder independent operators to overlap the NVDLA engines, or to lower
+  // the peak activation memory.
+  const NvDlaConstants& constants = *this;
+  addPass<NvDlaTensorSchedPass>(pPM, "NvDlaTensorSchedPass", constants, &m_pMeta, m_PerfModel, SCHED_POLICY,
+                                SCHED_DETERMINISTIC);
+  // Group CPU fallback operators to cut the # of DLA/EMU task switches.
+  addPass<NvDlaFallbackClusterPass>(pPM, "NvDlaFallbackClusterPass", &m_pMeta);
+  // Assign operators to NVDLA cores, cross-core tensors end a task entry.
+  addPass<NvDlaPartitionPass>(pPM, "NvDlaPartitionPass", constants, &m_pMeta, m_PerfModel, PARTITION_MODE,
+                              STREAMING);
 }
 
 void FooNvdlaBackend::addMemAlloc(PassManager& pPM)
@@ -98,34 +175,61 @@ void FooNvdlaBackend::addMemAlloc(PassManager& pPM)
   // Input: Module
   // Output: LiveIntervals
   addStandardCreateLiveIntervals(pPM);
+  addProfilePoint(pPM, "StandardCreateLiveIntervals");
 
   // Input: LiveIntervals
   // Output: MemAllocs
   addStandardMemoryAllocation(pPM, *this);
+  addProfilePoint(pPM, "StandardMemoryAllocation");
 
   // Input: MemAllocs
   // Output: Virtual memory address for each memory operands.
   addStandardSetMemOperands(pPM);
+  addProfilePoint(pPM, "StandardSetMemOperands");
 
   const NvDlaConstants& constants = *this;
-  pPM.add<NvDlaMemInfoPass>(constants, &m_pMeta);
+  addPass<NvDlaMemInfoPass>(pPM, "NvDlaMemInfoPass", constants, &m_pMeta, MEM_ALLOC_STRATEGY, DRAM_BUDGET);
 }
 
 void FooNvdlaBackend::addCodeEmit(PassManager& pPM, const Path& pOutput)
 {
   static foonvdla::CodeEmitVisitor ceVisitor(*this, m_pMeta);
-  pPM.add<CodeEmit>(ceVisitor)
-     .add<NvDlaTaskSubmitPass>(&m_pMeta, BLOB_DLA_VERSION, BLOB_EMU_VERSION)
-     .add<NvDlaFileGenPass>(&m_pMeta, LOADABLE_VERSION)
-    ;
+  addPass<NvDlaCodeEmitPass>(pPM, "NvDlaCodeEmitPass", ceVisitor, &m_pMeta);
+  addPass<NvDlaPerfReportPass>(pPM, "NvDlaPerfReportPass", &m_pMeta, m_PerfModel);
+  addPass<NvDlaTaskSubmitPass>(pPM, "NvDlaTaskSubmitPass", &m_pMeta, BLOB_DLA_VERSION, BLOB_EMU_VERSION, STREAMING,
+                               NUM_ROIS);
+  addPass<NvDlaFileGenPass>(pPM, "NvDlaFileGenPass", &m_pMeta, LOADABLE_VERSION);
+
+  if (PROFILE_PASSES) {
+    pPM.add<NvDlaProfileReportPass>(m_Profiler, PASS_PROFILE_FILE);
+  }
+}
+
+void FooNvdlaBackend::addProfilePoint(PassManager& pPM, const char* pName)
+{
+  // Without profiling, the pipeline is left as it is.
+  if (PROFILE_PASSES) {
+    pPM.add<NvDlaProfilePass>(m_Profiler, pName);
+  }
 }
 
 void FooNvdlaBackend::RegisterLowers(LowerRegistry& pRegistry) const
 {
   pRegistry.emplace<ConvLower>();
+  pRegistry.emplace<BatchNormalizationLower>();
   pRegistry.emplace<MulLower>();
   pRegistry.emplace<AddLower>();
+  pRegistry.emplace<SubLower>();
+  pRegistry.emplace<DivLower>();
   pRegistry.emplace<ReluLower>();
+  pRegistry.emplace<LogLower>();
+  pRegistry.emplace<PadLower>();
+  pRegistry.emplace<ReshapeLower>();
+  pRegistry.emplace<TransposeLower>();
+  pRegistry.emplace<ConcatLower>();
+  pRegistry.emplace<FlattenLower>();
+  pRegistry.emplace<SqueezeLower>();
+  pRegistry.emplace<UnsqueezeLower>();
 }
 
 
@@ -8,9 +8,18 @@
 #ifndef TARGET_FOONVDLA_FOONVDLA_BACKEND_H
 #define TARGET_FOONVDLA_FOONVDLA_BACKEND_H
 #include <string>
+#include <utility>
+#include <onnc/Core/PassManager.h>
 #include <onnc/Target/TargetBackend.h>
 #include "NvDlaDefine.h"
+#include "NvDlaIRSnapshot.h"
+#include "NvDlaMemAllocator.h"
 #include "NvDlaMeta.h"
+#include "NvDlaPartitionPass.h"
+#include "NvDlaPassProfiler.h"
+#include "NvDlaPerfModel.h"
+#include "NvDlaTensorSchedPass.h"
+#include "PrintONNCIRPass.h"
 #include "Version.h"
 
 namespace onnc {
@@ -22,6 +31,21 @@ private:
   static const Version LOADABLE_VERSION;
   static const Version BLOB_DLA_VERSION;
   static const Version BLOB_EMU_VERSION;
+  static const NvDlaMemAllocStrategy MEM_ALLOC_STRATEGY;
+  static const NvDlaBackendMeta::Size DRAM_BUDGET;
+  static const NvDlaSchedPolicy SCHED_POLICY;
+  static const bool SCHED_DETERMINISTIC;
+  static const bool STREAMING;
+  static const unsigned NUM_ROIS;
+  static const NvDlaPartitionMode PARTITION_MODE;
+  static const double DRAM_BYTES_PER_CYCLE;
+  static const bool PROFILE_PASSES;
+  static const char* const PASS_PROFILE_FILE;
+  static const char* const PRINT_BEFORE;
+  static const char* const PRINT_AFTER;
+  static const char* const PRINT_OP_KINDS;
+  static const char* const PRINT_DIR;
+  static const NvDlaIRFormat PRINT_FORMAT;
   
 public:
   FooNvdlaBackend(const TargetOptions& pOptions);
@@ -40,8 +64,33 @@ public:
 
   void RegisterLowers(LowerRegistry& pRegistry) const override;
 
+private:
+  /// Add @ref PassType and, with PROFILE_PASSES, a checkpoint of m_Profiler
+  /// which records the pass as @ref pName. The graph is printed before and
+  /// after the pass if m_PrintOptions asks for @ref pName.
+  template <typename PassType, typename... Args>
+  void addPass(PassManager& pPM, const char* pName, Args&&... pArgs)
+  {
+    if (m_PrintOptions.isPrintedBefore(pName)) {
+      pPM.add<PrintONNCIRPass>(m_PrintOptions, "before", pName);
+      addProfilePoint(pPM, "PrintONNCIRPass");
+    }
+    pPM.add<PassType>(std::forward<Args>(pArgs)...);
+    addProfilePoint(pPM, pName);
+    if (m_PrintOptions.isPrintedAfter(pName)) {
+      pPM.add<PrintONNCIRPass>(m_PrintOptions, "after", pName);
+      addProfilePoint(pPM, "PrintONNCIRPass");
+    }
+  }
+
+  /// Add a checkpoint of m_Profiler if PROFILE_PASSES, or nothing.
+  void addProfilePoint(PassManager& pPM, const char* pName);
+
 private:
   NvDlaBackendMeta       m_pMeta;
+  NvDlaPerfModel         m_PerfModel;
+  NvDlaPassProfiler      m_Profiler;
+  NvDlaIRPrintOptions    m_PrintOptions;
 };
 
 }  // namespace onnc
@@ -0,0 +1,73 @@
+//===- NvDlaBroadcast.cpp -------------------------------------------------===//
+//
+//                             The ONNC Project
+//
+// See LICENSE.TXT for details.
+//
+//===----------------------------------------------------------------------===//
+#include "NvDlaBroadcast.h"
+
+#include <algorithm>
+#include <functional>
+#include <numeric>
+
+namespace onnc {
+namespace foonvdla {
+
+//===----------------------------------------------------------------------===//
+// NvDlaBroadcast
+//===----------------------------------------------------------------------===//
+std::size_t NvDlaBroadcast::getNumOfElements(const Dimensions& dims)
+{
+  return std::accumulate(dims.begin(), dims.end(), std::size_t{1}, std::multiplies<std::size_t>());
+}
+
+bool NvDlaBroadcast::getDimensions(const Dimensions& lhs, const Dimensions& rhs, Dimensions& result)
+{
+  const std::size_t rank = std::max(lhs.size(), rhs.size());
+  Dimensions        dims(rank, 1);
+  for (std::size_t idx = 0; idx < rank; ++idx) {
+    const Tensor::Dimension lhsDim = (idx < rank - lhs.size() ? 1 : lhs[idx - (rank - lhs.size())]);
+    const Tensor::Dimension rhsDim = (idx < rank - rhs.size() ? 1 : rhs[idx - (rank - rhs.size())]);
+    if (lhsDim != rhsDim && lhsDim != 1 && rhsDim != 1) {
+      return false;
+    }
+    dims[idx] = std::max(lhsDim, rhsDim);
+  }
+
+  result = std::move(dims);
+  return true;
+}
+
+NvDlaBroadcast::Strides NvDlaBroadcast::getStrides(const Dimensions& dims, std::size_t rank)
+{
+  Strides     strides(rank, 0);
+  std::size_t stride = 1;
+  for (std::size_t idx = dims.size(); 0 < idx; --idx) {
+    strides[rank - dims.size() + idx - 1] = (dims[idx - 1] == 1 ? 0 : stride);
+    stride *= dims[idx - 1];
+  }
+  return strides;
+}
+
+void NvDlaBroadcast::advance(Index& index, const Dimensions& dims)
+{
+  for (std::size_t axis = dims.size(); 0 < axis; --axis) {
+    if (++index[axis - 1] < dims[axis - 1]) {
+      return;
+    }
+    index[axis - 1] = 0;
+  }
+}
+
+std::size_t NvDlaBroadcast::getOffset(const Index& index, const Strides& strides)
+{
+  std::size_t offset = 0;
+  for (std::size_t axis = 0; axis < index.size(); ++axis) {
+    offset += index[axis] * strides[axis];
+  }
+  return offset;
+}
+
+} // namespace foonvdla
+} // namespace onnc
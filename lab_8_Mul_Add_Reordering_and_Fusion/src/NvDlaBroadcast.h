@@ -0,0 +1,65 @@
+//===- NvDlaBroadcast.h ---------------------------------------------------===//
+//
+//                             The ONNC Project
+//
+// See LICENSE.TXT for details.
+//
+//===----------------------------------------------------------------------===//
+#ifndef TARGET_FOONVDLA_NVDLA_BROADCAST_H
+#define TARGET_FOONVDLA_NVDLA_BROADCAST_H
+
+#include <onnc/IR/Compute/Tensor.h>
+
+#include <cstddef>
+#include <vector>
+
+namespace onnc {
+namespace foonvdla {
+
+/** \class NvDlaBroadcast
+ *  \brief Numpy-style broadcasting of constant tensor values at compile time.
+ */
+class NvDlaBroadcast
+{
+public:
+  using Dimensions = Tensor::Dimensions;
+  using Index      = std::vector<Tensor::Dimension>;
+  using Strides    = std::vector<std::size_t>;
+
+public:
+  static std::size_t getNumOfElements(const Dimensions& dims);
+
+  /// Broadcast @ref lhs and @ref rhs to @ref result, false if they are incompatible.
+  static bool getDimensions(const Dimensions& lhs, const Dimensions& rhs, Dimensions& result);
+
+  /// Strides of @ref dims right-aligned to @ref rank axes, 0 on the broadcast axes.
+  static Strides getStrides(const Dimensions& dims, std::size_t rank);
+
+  /// Advance @ref index over @ref dims in the row-major order.
+  static void advance(Index& index, const Dimensions& dims);
+
+  static std::size_t getOffset(const Index& index, const Strides& strides);
+
+  /// Repeat @ref values of @ref from along the broadcast axes of @ref to.
+  template <typename ValueType>
+  static std::vector<ValueType> expand(const std::vector<ValueType>& values, const Dimensions& from,
+                                       const Dimensions& to)
+  {
+    const Strides          strides = getStrides(from, to.size());
+    const std::size_t      size    = getNumOfElements(to);
+    std::vector<ValueType> result;
+    result.reserve(size);
+
+    Index index(to.size(), 0);
+    for (std::size_t count = 0; count < size; ++count) {
+      result.push_back(values[getOffset(index, strides)]);
+      advance(index, to);
+    }
+    return result;
+  }
+};
+
+} // namespace foonvdla
+} // namespace onnc
+
+#endif
@@ -0,0 +1,73 @@
+//===- NvDlaCodeEmitPass.cpp ----------------------------------------------===//
+//
+//                             The ONNC Project
+//
+// See LICENSE.TXT for details.
+//
+//===----------------------------------------------------------------------===//
+#include "NvDlaCodeEmitPass.h"
+
+#include <onnc/Core/PassSupport.h>
+#include <onnc/IR/Compute/BatchNormalization.h>
+#include <onnc/IR/Compute/Concat.h>
+#include <onnc/IR/Compute/Div.h>
+#include <onnc/IR/Compute/Flatten.h>
+#include <onnc/IR/Compute/Pad.h>
+#include <onnc/IR/Compute/Squeeze.h>
+#include <onnc/IR/Compute/Sub.h>
+#include <onnc/IR/Compute/Transpose.h>
+#include <onnc/IR/Compute/Unsqueeze.h>
+#include <onnc/IR/ComputeOperator.h>
+#include <onnc/Support/Casting.h>
+#include <onnc/Support/IOStream.h>
+
+namespace onnc {
+namespace foonvdla {
+
+namespace internal {
+
+// Lowered only to be folded by addOnncIrOptimization, there is no code
+// emitting function for them.
+bool isFoldOnly(const ComputeOperator& op)
+{
+  return isa<BatchNormalization>(&op) || isa<Pad>(&op) || isa<Transpose>(&op) || isa<Sub>(&op) || isa<Div>(&op) ||
+         isa<Concat>(&op) || isa<Flatten>(&op) || isa<Squeeze>(&op) || isa<Unsqueeze>(&op);
+}
+
+} // namespace internal
+
+//===----------------------------------------------------------------------===//
+// NvDlaCodeEmitPass
+//===----------------------------------------------------------------------===//
+NvDlaCodeEmitPass::NvDlaCodeEmitPass(ComputeVisitor& pVisitor, NvDlaBackendMeta* pMeta) noexcept
+  : m_Visitor(pVisitor)
+  , m_pMeta(pMeta)
+{}
+
+Pass::ReturnType NvDlaCodeEmitPass::runOnModule(Module& pModule)
+{
+  for (const ComputeOperator& op : *pModule.getRootComputeGraph()) {
+    if (internal::isFoldOnly(op)) {
+      errs() << "NvDlaCodeEmitPass: " << op.name() << " " << op.getOutput(0)->getName()
+             << " was not folded and cannot be emitted\n";
+      return Pass::kPassFailure;
+    }
+  }
+
+  if (m_pMeta->m_OperatorSchedule.empty()) {
+    for (ComputeOperator& op : *pModule.getRootComputeGraph()) {
+      op.accept(m_Visitor);
+    }
+    return Pass::kModuleNoChanged;
+  }
+
+  for (ComputeOperator* op : m_pMeta->m_OperatorSchedule) {
+    const auto found       = m_pMeta->m_OperatorCores.find(op);
+    m_pMeta->m_CurrentCore = (found == m_pMeta->m_OperatorCores.end() ? 0 : found->second);
+    op->accept(m_Visitor);
+  }
+  return Pass::kModuleNoChanged;
+}
+
+} // namespace foonvdla
+} // namespace onnc
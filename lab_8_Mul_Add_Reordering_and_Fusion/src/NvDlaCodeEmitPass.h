@@ -0,0 +1,41 @@
+//===- NvDlaCodeEmitPass.h ------------------------------------------------===//
+//
+//                             The ONNC Project
+//
+// See LICENSE.TXT for details.
+//
+//===----------------------------------------------------------------------===//
+#ifndef ONNC_FOONVDLA_CODE_EMIT_PASS_H
+#define ONNC_FOONVDLA_CODE_EMIT_PASS_H
+#include "NvDlaMeta.h"
+
+#include <onnc/Core/CustomPass.h>
+#include <onnc/IR/ComputeVisitor.h>
+
+namespace onnc {
+namespace foonvdla {
+
+/** \class NvDlaCodeEmitPass
+ *  \brief Visit operators in the order chosen by the scheduling passes.
+ *
+ *  Same as onnc::CodeEmit, but follows NvDlaBackendMeta::m_OperatorSchedule
+ *  when a schedule was recorded, and the compute graph order otherwise. The
+ *  core chosen by NvDlaPartitionPass is recorded for every emitted operation.
+ *  Fails if an operator which is lowered only to be folded is still left.
+ */
+class NvDlaCodeEmitPass : public CustomPass<NvDlaCodeEmitPass>
+{
+public:
+  NvDlaCodeEmitPass(ComputeVisitor& pVisitor, NvDlaBackendMeta* pMeta) noexcept;
+
+  ReturnType runOnModule(Module& pModule) override;
+
+private:
+  ComputeVisitor&   m_Visitor;
+  NvDlaBackendMeta* m_pMeta;
+};
+
+} // namespace foonvdla
+} // namespace onnc
+
+#endif
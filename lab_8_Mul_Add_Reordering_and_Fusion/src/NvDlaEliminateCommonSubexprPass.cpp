@@ -0,0 +1,189 @@
+//===- NvDlaEliminateCommonSubexprPass.cpp --------------------------------===//
+//
+//                             The ONNC Project
+//
+// See LICENSE.TXT for details.
+//
+//===----------------------------------------------------------------------===//
+#include "NvDlaEliminateCommonSubexprPass.h"
+
+#include <onnc/Core/PassSupport.h>
+#include <onnc/IR/Compute/Initializer.h>
+#include <onnc/IR/Compute/InputOperator.h>
+#include <onnc/IR/Compute/OutputOperator.h>
+#include <onnc/IR/ComputeOperator.h>
+
+#include <cstdint>
+#include <iostream>
+#include <sstream>
+#include <unordered_map>
+#include <vector>
+
+namespace onnc {
+namespace foonvdla {
+
+namespace internal {
+
+bool hasGraphOutput(const ComputeOperator& op)
+{
+  for (unsigned idx = 0; idx < op.getNumOfOutputs(); ++idx) {
+    for (const auto& use : op.getOutput(idx)->getUses()) {
+      if (isa<OutputOperator>(use.getUser())) {
+        return true;
+      }
+    }
+  }
+  return false;
+}
+
+/// FNV-1a of the bytes of @ref values.
+template <typename ValueType>
+std::uint64_t hashValues(const std::vector<ValueType>& values)
+{
+  const auto*   bytes = reinterpret_cast<const unsigned char*>(values.data());
+  std::uint64_t hash  = 14695981039346656037ull;
+  for (std::size_t idx = 0; idx < values.size() * sizeof(ValueType); ++idx) {
+    hash = (hash ^ bytes[idx]) * 1099511628211ull;
+  }
+  return hash;
+}
+
+/// The type and the hash of the values of a constant, false for other tensors
+/// and for constants whose values are not loaded.
+bool getConstantKey(const Tensor& tensor, std::ostream& key)
+{
+  std::size_t numOfElements = 1;
+  for (Tensor::Dimension dim : tensor.getDimensions()) {
+    numOfElements *= dim;
+  }
+
+  if (const FloatTensor* constant = dynamic_cast<const FloatTensor*>(&tensor)) {
+    if (constant->getValues().size() != numOfElements) {
+      return false;
+    }
+    key << "f32:" << hashValues(constant->getValues());
+  } else if (const Int64Tensor* constant = dynamic_cast<const Int64Tensor*>(&tensor)) {
+    if (constant->getValues().size() != numOfElements) {
+      return false;
+    }
+    key << "i64:" << hashValues(constant->getValues());
+  } else {
+    return false;
+  }
+
+  for (Tensor::Dimension dim : tensor.getDimensions()) {
+    key << ',' << dim;
+  }
+  return true;
+}
+
+} // namespace internal
+
+//===----------------------------------------------------------------------===//
+// NvDlaEliminateCommonSubexprPass
+//===----------------------------------------------------------------------===//
+Pass::ReturnType NvDlaEliminateCommonSubexprPass::runOnModule(Module& pModule)
+{
+  // Duplicates and their outputs are erased right after they are merged.
+  return BaseType::runOnModule(pModule);
+}
+
+Pass::ReturnType NvDlaEliminateCommonSubexprPass::runOnComputeGraph(ComputeGraph& pCG)
+{
+  Pass::ReturnType ret = Pass::kModuleNoChanged;
+
+  std::vector<ComputeOperator*> order;
+  for (ComputeOperator& op : pCG) {
+    order.emplace_back(&op);
+  }
+
+  // Operators with the same key, which may still differ by a hash collision
+  // of constant values.
+  std::unordered_map<std::string, std::vector<ComputeOperator*>> visited;
+  unsigned                                                       numOfMerged = 0;
+  for (ComputeOperator* op : order) {
+    std::string key;
+    if (!getKey(*op, key)) {
+      continue;
+    }
+
+    std::vector<ComputeOperator*>& candidates = visited[key];
+    ComputeOperator*               original   = nullptr;
+    for (ComputeOperator* candidate : candidates) {
+      if (isEquivalent(*candidate, *op)) {
+        original = candidate;
+        break;
+      }
+    }
+    if (original == nullptr) {
+      candidates.emplace_back(op);
+      continue;
+    }
+
+    // Let the users read the outputs of the original, and drop the duplicate.
+    std::vector<Value*> outputs;
+    for (unsigned idx = 0; idx < op->getNumOfOutputs(); ++idx) {
+      op->getOutput(idx)->replaceAllUsesWith(*original->getOutput(idx));
+      outputs.emplace_back(op->getOutput(idx));
+    }
+    op->removeAllInputs();
+    op->removeAllOutputs();
+    pCG.erase(*op);
+    for (Value* output : outputs) {
+      pCG.erase(*output);
+    }
+    ++numOfMerged;
+  }
+
+  if (numOfMerged != 0) {
+    std::cout << "NvDlaEliminateCommonSubexprPass: merged " << numOfMerged << " operators\n";
+    ret |= Pass::kModuleChanged;
+  }
+
+  return ret;
+}
+
+bool NvDlaEliminateCommonSubexprPass::getKey(const ComputeOperator& op, std::string& key)
+{
+  // Graph inputs and outputs are never the same, and a graph output keeps its
+  // name, so it is not replaced.
+  if (isa<InputOperator>(&op) || isa<OutputOperator>(&op) || op.getNumOfOutputs() == 0 ||
+      internal::hasGraphOutput(op)) {
+    return false;
+  }
+
+  std::ostringstream os;
+  os << op.getID() << ':' << op.getNumOfOutputs() << ':';
+  if (isa<Initializer>(&op)) {
+    if (!internal::getConstantKey(*op.getOutput(0), os)) {
+      return false;
+    }
+  } else {
+    op.printAttributes(os);
+    for (unsigned idx = 0; idx < op.getNumOfInputs(); ++idx) {
+      os << ':' << op.getInput(idx);
+    }
+  }
+
+  key = os.str();
+  return true;
+}
+
+bool NvDlaEliminateCommonSubexprPass::isEquivalent(const ComputeOperator& op, const ComputeOperator& other)
+{
+  // The key of an operator other than an Initializer names its inputs.
+  if (!isa<Initializer>(&op)) {
+    return true;
+  }
+
+  const Tensor& tensor      = *op.getOutput(0);
+  const Tensor& otherTensor = *other.getOutput(0);
+  if (const FloatTensor* constant = dynamic_cast<const FloatTensor*>(&tensor)) {
+    return constant->getValues() == static_cast<const FloatTensor&>(otherTensor).getValues();
+  }
+  return static_cast<const Int64Tensor&>(tensor).getValues() ==
+         static_cast<const Int64Tensor&>(otherTensor).getValues();
+}
+
+} // namespace foonvdla
+} // namespace onnc
@@ -0,0 +1,45 @@
+//===- NvDlaEliminateCommonSubexprPass.h ----------------------------------===//
+//
+//                             The ONNC Project
+//
+// See LICENSE.TXT for details.
+//
+//===----------------------------------------------------------------------===//
+#ifndef ONNC_FOONVDLA_ELIMINATE_COMMON_SUBEXPR_PASS_H
+#define ONNC_FOONVDLA_ELIMINATE_COMMON_SUBEXPR_PASS_H
+#include <onnc/Core/CustomPass.h>
+
+#include <string>
+
+namespace onnc {
+namespace foonvdla {
+
+/** \class NvDlaEliminateCommonSubexprPass
+ *  \brief Merge operators of the same kind and attributes on the same inputs.
+ *
+ *  Operators are keyed by (kind, attributes, inputs) in one traversal by the
+ *  topological order, so the inputs of an operator are already merged when
+ *  it is visited. Initializers with the same values are merged as well. The
+ *  users of a duplicate read the outputs of the first operator instead, which
+ *  leaves single-use chains for the fusion passes.
+ */
+class NvDlaEliminateCommonSubexprPass : public CustomPass<NvDlaEliminateCommonSubexprPass>
+{
+public:
+  NvDlaEliminateCommonSubexprPass() = default;
+
+  ReturnType runOnModule(Module& pModule) override;
+
+  ReturnType runOnComputeGraph(ComputeGraph& pCG) override;
+
+private:
+  /// The key of @ref op, false if it must not be merged.
+  static bool getKey(const ComputeOperator& op, std::string& key);
+
+  static bool isEquivalent(const ComputeOperator& op, const ComputeOperator& other);
+};
+
+} // namespace foonvdla
+} // namespace onnc
+
+#endif
@@ -0,0 +1,81 @@
+//===- NvDlaEngine.cpp ----------------------------------------------------===//
+//
+//                             The ONNC Project
+//
+// See LICENSE.TXT for details.
+//
+//===----------------------------------------------------------------------===//
+#include "NvDlaEngine.h"
+
+#include "Compute/NvDlaAddMulRelu.h"
+
+#include <onnc/IR/Compute/Add.h>
+#include <onnc/IR/Compute/AveragePool.h>
+#include <onnc/IR/Compute/BatchNormalization.h>
+#include <onnc/IR/Compute/Concat.h>
+#include <onnc/IR/Compute/Conv.h>
+#include <onnc/IR/Compute/Initializer.h>
+#include <onnc/IR/Compute/InputOperator.h>
+#include <onnc/IR/Compute/LRN.h>
+#include <onnc/IR/Compute/MaxPool.h>
+#include <onnc/IR/Compute/Mul.h>
+#include <onnc/IR/Compute/OutputOperator.h>
+#include <onnc/IR/Compute/Relu.h>
+#include <onnc/IR/Compute/Reshape.h>
+#include <onnc/IR/Compute/Transpose.h>
+#include <onnc/Support/Casting.h>
+
+namespace onnc {
+namespace foonvdla {
+
+//===----------------------------------------------------------------------===//
+// NvDlaEngineModel
+//===----------------------------------------------------------------------===//
+NvDlaEngine NvDlaEngineModel::getEngine(const ComputeOperator& op)
+{
+  // a Reshape aliases the memory of its input and emits no operation
+  if (isa<InputOperator>(&op) || isa<OutputOperator>(&op) || isa<Initializer>(&op) || isa<Reshape>(&op)) {
+    return NvDlaEngine::kNone;
+  } else if (isa<Conv>(&op)) {
+    return NvDlaEngine::kConv;
+  } else if (isa<Add>(&op) || isa<Mul>(&op) || isa<Relu>(&op) || isa<BatchNormalization>(&op) ||
+             isa<NvDlaAddMulRelu>(&op)) {
+    return NvDlaEngine::kSdp;
+  } else if (isa<MaxPool>(&op) || isa<AveragePool>(&op)) {
+    return NvDlaEngine::kPdp;
+  } else if (isa<LRN>(&op)) {
+    return NvDlaEngine::kCdp;
+  } else if (isa<Concat>(&op) || isa<Transpose>(&op)) {
+    return NvDlaEngine::kRubik;
+  }
+
+  return NvDlaEngine::kEmu;
+}
+
+const char* NvDlaEngineModel::getName(NvDlaEngine engine)
+{
+  switch (engine) {
+  case NvDlaEngine::kNone:
+    return "none";
+  case NvDlaEngine::kConv:
+    return "CONV";
+  case NvDlaEngine::kSdp:
+    return "SDP";
+  case NvDlaEngine::kPdp:
+    return "PDP";
+  case NvDlaEngine::kCdp:
+    return "CDP";
+  case NvDlaEngine::kRubik:
+    return "RUBIK";
+  case NvDlaEngine::kBdma:
+    return "BDMA";
+  case NvDlaEngine::kEmu:
+    return "EMU";
+  default:
+    break;
+  }
+  return "unknown";
+}
+
+} // namespace foonvdla
+} // namespace onnc
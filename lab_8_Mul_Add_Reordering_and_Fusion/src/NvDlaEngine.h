@@ -0,0 +1,45 @@
+//===- NvDlaEngine.h ------------------------------------------------------===//
+//
+//                             The ONNC Project
+//
+// See LICENSE.TXT for details.
+//
+//===----------------------------------------------------------------------===//
+#ifndef TARGET_FOONVDLA_NVDLA_ENGINE_H
+#define TARGET_FOONVDLA_NVDLA_ENGINE_H
+
+#include <onnc/IR/ComputeOperator.h>
+
+namespace onnc {
+namespace foonvdla {
+
+/// Hardware block which executes an operator. Operators on different engines
+/// may run at the same time if they do not depend on each other.
+enum class NvDlaEngine : unsigned
+{
+  kNone = 0, // no work (graph inputs, outputs and initializers)
+  kConv,
+  kSdp,
+  kPdp,
+  kCdp,
+  kRubik,
+  kBdma,
+  kEmu, // CPU fallback
+  kNumEngines
+};
+
+/** \class NvDlaEngineModel
+ *  \brief Map operators to NVDLA engines. Their costs are given by NvDlaPerfModel.
+ */
+class NvDlaEngineModel
+{
+public:
+  static NvDlaEngine getEngine(const ComputeOperator& op);
+
+  static const char* getName(NvDlaEngine engine);
+};
+
+} // namespace foonvdla
+} // namespace onnc
+
+#endif
@@ -0,0 +1,153 @@
+//===- NvDlaFallbackClusterPass.cpp ---------------------------------------===//
+//
+//                             The ONNC Project
+//
+// See LICENSE.TXT for details.
+//
+//===----------------------------------------------------------------------===//
+#include "NvDlaFallbackClusterPass.h"
+
+#include "NvDlaEngine.h"
+#include "NvDlaUtil.h"
+
+#include <onnc/Core/PassSupport.h>
+#include <onnc/IR/ComputeOperator.h>
+
+#include <algorithm>
+#include <cassert>
+#include <iostream>
+#include <unordered_map>
+
+namespace onnc {
+namespace foonvdla {
+
+//===----------------------------------------------------------------------===//
+// NvDlaFallbackClusterPass
+//===----------------------------------------------------------------------===//
+NvDlaFallbackClusterPass::NvDlaFallbackClusterPass(NvDlaBackendMeta* pMeta) noexcept
+  : m_pMeta{pMeta}
+{}
+
+Pass::ReturnType NvDlaFallbackClusterPass::runOnModule(Module& pModule)
+{
+  const OperatorList original = (m_pMeta->m_OperatorSchedule.empty()
+                                   ? NvDlaLiveness::getOperatorList(*pModule.getRootComputeGraph())
+                                   : m_pMeta->m_OperatorSchedule);
+
+  // try both categories for the first task, and keep the order with fewer tasks
+  OperatorList best      = original;
+  unsigned     bestTasks = getNumOfTasks(original);
+  for (Category first : {Category::dla, Category::emu}) {
+    OperatorList   clustered = cluster(original, first);
+    const unsigned numTasks  = getNumOfTasks(clustered);
+    if (numTasks < bestTasks) {
+      best      = std::move(clustered);
+      bestTasks = numTasks;
+    }
+  }
+
+  std::cout << "NvDlaFallbackClusterPass: task entries " << getNumOfTasks(original) << " -> " << bestTasks << "\n";
+
+  m_pMeta->m_OperatorSchedule = std::move(best);
+  return Pass::kModuleNoChanged;
+}
+
+unsigned NvDlaFallbackClusterPass::getNumOfTasks(const OperatorList& pOrder)
+{
+  unsigned numTasks = 0;
+  Category current  = Category::none;
+  for (const ComputeOperator* op : pOrder) {
+    const Category category = getCategory(*op);
+    if (category != Category::none && category != current) {
+      ++numTasks;
+      current = category;
+    }
+  }
+  return numTasks;
+}
+
+NvDlaFallbackClusterPass::Category NvDlaFallbackClusterPass::getCategory(const ComputeOperator& op)
+{
+  switch (NvDlaEngineModel::getEngine(op)) {
+  case NvDlaEngine::kNone:
+    return Category::none;
+  case NvDlaEngine::kEmu:
+    return Category::emu;
+  default:
+    break;
+  }
+  return Category::dla;
+}
+
+NvDlaFallbackClusterPass::OperatorList NvDlaFallbackClusterPass::cluster(const OperatorList& pOrder,
+                                                                         Category            first) const
+{
+  std::unordered_map<const ComputeOperator*, std::size_t> position;
+  for (std::size_t idx = 0; idx < pOrder.size(); ++idx) {
+    position.emplace(pOrder[idx], idx);
+  }
+
+  // # of inputs whose producer is not scheduled yet
+  std::unordered_map<const ComputeOperator*, unsigned> numPendingInputs;
+  std::vector<ComputeOperator*>                        ready;
+  for (ComputeOperator* op : pOrder) {
+    unsigned& numPending = numPendingInputs[op];
+    for (unsigned idx = 0; idx < op->getNumOfInputs(); ++idx) {
+      const Tensor* input = dynamic_cast<const Tensor*>(op->getInput(idx));
+      if (input != nullptr && position.count(getProducer(*input)) != 0) {
+        ++numPending;
+      }
+    }
+
+    if (numPending == 0) {
+      ready.emplace_back(op);
+    }
+  }
+
+  OperatorList schedule;
+  schedule.reserve(pOrder.size());
+  Category current = first;
+  while (!ready.empty()) {
+    // pick the earliest ready operator which does not start a new task, switch
+    // to the other category only if there is none.
+    auto best = ready.end();
+    for (auto it = ready.begin(); it != ready.end(); ++it) {
+      const Category category = getCategory(**it);
+      if (category != Category::none && category != current) {
+        continue;
+      }
+      if (best == ready.end() || position[*it] < position[*best]) {
+        best = it;
+      }
+    }
+
+    if (best == ready.end()) {
+      current = (current == Category::dla ? Category::emu : Category::dla);
+      continue;
+    }
+
+    ComputeOperator* op = *best;
+    ready.erase(best);
+    schedule.emplace_back(op);
+
+    for (unsigned idx = 0; idx < op->getNumOfOutputs(); ++idx) {
+      const Tensor* output = dynamic_cast<const Tensor*>(op->getOutput(idx));
+      if (output == nullptr) {
+        continue;
+      }
+
+      for (const auto& use : output->getUses()) {
+        ComputeOperator* user = use.getUser();
+        if (position.count(user) != 0 && --numPendingInputs[user] == 0) {
+          ready.emplace_back(user);
+        }
+      }
+    }
+  }
+
+  assert(schedule.size() == pOrder.size() && "the compute graph should be acyclic");
+  return schedule;
+}
+
+} // namespace foonvdla
+} // namespace onnc
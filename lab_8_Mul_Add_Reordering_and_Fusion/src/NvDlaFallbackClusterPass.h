@@ -0,0 +1,55 @@
+//===- NvDlaFallbackClusterPass.h -----------------------------------------===//
+//
+//                             The ONNC Project
+//
+// See LICENSE.TXT for details.
+//
+//===----------------------------------------------------------------------===//
+#ifndef ONNC_FOONVDLA_FALLBACK_CLUSTER_PASS_H
+#define ONNC_FOONVDLA_FALLBACK_CLUSTER_PASS_H
+#include "NvDlaLiveness.h"
+#include "NvDlaMeta.h"
+
+#include <onnc/Core/CustomPass.h>
+
+namespace onnc {
+namespace foonvdla {
+
+/** \class NvDlaFallbackClusterPass
+ *  \brief Reorder independent operators so that CPU fallback operators are
+ *  grouped together.
+ *
+ *  Every switch between DLA and EMU operators in the emitting order starts a
+ *  new task entry, which costs a synchronization between the processors. The
+ *  pass keeps taking ready operators of the current category and only switches
+ *  when there is none left. The operator order from the previous scheduling
+ *  pass (NvDlaBackendMeta::m_OperatorSchedule) breaks the ties.
+ */
+class NvDlaFallbackClusterPass : public CustomPass<NvDlaFallbackClusterPass>
+{
+public:
+  using OperatorList = NvDlaLiveness::OperatorList;
+  using Category     = NvDlaBackendMeta::OperationMeta::Category;
+
+public:
+  explicit NvDlaFallbackClusterPass(NvDlaBackendMeta* pMeta) noexcept;
+
+  ReturnType runOnModule(Module& pModule) override;
+
+  /// # of task entries NvDlaTaskSubmitPass creates for @ref pOrder.
+  static unsigned getNumOfTasks(const OperatorList& pOrder);
+
+  /// Operators with Category::none emit nothing and never split a task.
+  static Category getCategory(const ComputeOperator& op);
+
+private:
+  OperatorList cluster(const OperatorList& pOrder, Category first) const;
+
+private:
+  NvDlaBackendMeta* m_pMeta;
+};
+
+} // namespace foonvdla
+} // namespace onnc
+
+#endif
@@ -0,0 +1,199 @@
+//===- NvDlaFoldBatchNormPass.cpp -----------------------------------------===//
+//
+//                             The ONNC Project
+//
+// See LICENSE.TXT for details.
+//
+//===----------------------------------------------------------------------===//
+#include "NvDlaFoldBatchNormPass.h"
+
+#include "NvDlaUtil.h"
+
+#include <onnc/Core/PassSupport.h>
+#include <onnc/IR/Compute/BatchNormalization.h>
+#include <onnc/IR/Compute/Conv.h>
+#include <onnc/IR/Compute/Initializer.h>
+#include <onnc/IR/ComputeOperator.h>
+
+#include <cassert>
+#include <cmath>
+#include <iostream>
+#include <string>
+#include <vector>
+
+namespace onnc {
+namespace foonvdla {
+
+namespace internal {
+
+/// The values of a constant float tensor with @ref size elements, or nullptr.
+const std::vector<float>* getConstantValues(const Tensor* tensor, std::size_t size)
+{
+  const FloatTensor* constant = dynamic_cast<const FloatTensor*>(tensor);
+  if (constant == nullptr || !isConstant(*constant) || constant->getValues().size() != size) {
+    return nullptr;
+  }
+  return &constant->getValues();
+}
+
+Tensor::Dimension getNumOfOutputChannels(const Conv& conv) { return conv.getInput(1)->dimension(0); }
+
+bool hasConstantWeight(const ComputeOperator& op)
+{
+  const Conv&        conv        = *dyn_cast<Conv>(&op);
+  const std::size_t  numChannels = getNumOfOutputChannels(conv);
+  const FloatTensor* weight      = dynamic_cast<const FloatTensor*>(conv.getInput(1));
+  if (weight == nullptr || weight->getValues().empty() ||
+      getConstantValues(weight, weight->getValues().size()) == nullptr ||
+      weight->getValues().size() % numChannels != 0) {
+    return false;
+  }
+  return conv.getNumOfInputs() < 3 || getConstantValues(conv.getInput(2), numChannels) != nullptr;
+}
+
+bool isInference(const ComputeOperator& op)
+{
+  // only Y is read in inference mode, the running statistics are not
+  for (unsigned idx = 1; idx < op.getNumOfOutputs(); ++idx) {
+    if (!op.getOutput(idx)->getUses().empty()) {
+      return false;
+    }
+  }
+
+  const Conv* conv = dyn_cast<Conv>(static_cast<ComputeOperator*>(op.getInput(0)->getDefine()));
+  if (conv == nullptr) {
+    return false;
+  }
+
+  const std::size_t numChannels = getNumOfOutputChannels(*conv);
+  for (unsigned idx = 1; idx < 5; ++idx) {
+    if (op.getNumOfInputs() <= idx || getConstantValues(op.getInput(idx), numChannels) == nullptr) {
+      return false;
+    }
+  }
+  return true;
+}
+
+} // namespace internal
+
+//===----------------------------------------------------------------------===//
+// NvDlaFoldBatchNormPass
+//===----------------------------------------------------------------------===//
+unsigned NvDlaFoldBatchNormPass::tensorIdx = 0;
+
+NvDlaFoldBatchNormPass::NvDlaFoldBatchNormPass()
+  : m_Pattern{NvDlaPattern("ConvBatchNorm")
+                .op<Conv>()
+                .singleUse()
+                .where(internal::hasConstantWeight)
+                .op<BatchNormalization>()
+                .where(internal::isInference)}
+{
+  // The Conv result must only be normalized, since its values change.
+}
+
+Pass::ReturnType NvDlaFoldBatchNormPass::runOnComputeGraph(ComputeGraph& pCG)
+{
+  Pass::ReturnType ret = Pass::kModuleNoChanged;
+
+  NvDlaRewriteDriver driver(pCG);
+  driver.add(m_Pattern, [this](const NvDlaPatternMatch& match, NvDlaRewriteDriver& rewriter) {
+    fold(match, rewriter);
+  });
+
+  const unsigned numOfFolded = driver.run();
+  if (numOfFolded != 0) {
+    std::cout << "NvDlaFoldBatchNormPass: folded " << numOfFolded << " BatchNormalization into Conv\n";
+    ret |= Pass::kModuleChanged;
+  }
+
+  return ret;
+}
+
+void NvDlaFoldBatchNormPass::fold(const NvDlaPatternMatch& match, NvDlaRewriteDriver& driver)
+{
+  Conv*               conv = dyn_cast<Conv>(match.operators[0]);
+  BatchNormalization* bn   = dyn_cast<BatchNormalization>(match.operators[1]);
+
+  Tensor*      input   = conv->getInput(0);
+  FloatTensor* weight  = dynamic_cast<FloatTensor*>(conv->getInput(1));
+  FloatTensor* bias    = (conv->getNumOfInputs() < 3 ? nullptr : dynamic_cast<FloatTensor*>(conv->getInput(2)));
+  Tensor*      convY   = conv->getOutput(0);
+  Tensor*      outputY = bn->getOutput(0);
+
+  const std::vector<float>& scale    = dynamic_cast<FloatTensor*>(bn->getInput(1))->getValues();
+  const std::vector<float>& shift    = dynamic_cast<FloatTensor*>(bn->getInput(2))->getValues();
+  const std::vector<float>& mean     = dynamic_cast<FloatTensor*>(bn->getInput(3))->getValues();
+  const std::vector<float>& variance = dynamic_cast<FloatTensor*>(bn->getInput(4))->getValues();
+  const float               epsilon  = bn->getEpsilon().value();
+
+  // Create the folded weight and bias, the original ones may be shared.
+  const std::string suffix = "__bn_" + std::to_string(tensorIdx++);
+
+  FloatTensor* newWeight = dynamic_cast<FloatTensor*>(weight->create());
+  newWeight->setName(weight->getName() + suffix);
+  newWeight->setDimensions(weight->getDimensions());
+
+  FloatTensor* newBias = dynamic_cast<FloatTensor*>(weight->create());
+  newBias->setName((bias != nullptr ? bias->getName() : convY->getName() + "_bias") + suffix);
+  newBias->setDimensions({static_cast<Tensor::Dimension>(scale.size())});
+
+  const std::size_t numChannels = scale.size();
+  const std::size_t kernelSize  = weight->getValues().size() / numChannels;
+  for (std::size_t channel = 0; channel < numChannels; ++channel) {
+    const float factor = scale[channel] / std::sqrt(variance[channel] + epsilon);
+    for (std::size_t idx = 0; idx < kernelSize; ++idx) {
+      newWeight->getValues().push_back(weight->getValues()[channel * kernelSize + idx] * factor);
+    }
+
+    const float oldBias = (bias != nullptr ? bias->getValues()[channel] : 0.0f);
+    newBias->getValues().push_back((oldBias - mean[channel]) * factor + shift[channel]);
+  }
+
+  newWeight = driver.getGraph().addValue<FloatTensor>(newWeight);
+  newBias   = driver.getGraph().addValue<FloatTensor>(newBias);
+  assert((newWeight != nullptr && newBias != nullptr) && "The name must be unique");
+  driver.addOperator<Initializer>()->setTensor(*newWeight);
+  driver.addOperator<Initializer>()->setTensor(*newBias);
+
+  // The current ONNC IR graph status
+  // ================================
+  //
+  //    |      |       |
+  //  input  weight  (bias)
+  //      \    |    /
+  //        (conv)
+  //          |
+  //        convY   scale, B, mean, var
+  //           \     /
+  //            (bn)
+  //             |
+  //          outputY
+  //             |
+
+  conv->removeAllInputs();
+  conv->removeAllOutputs();
+  bn->removeAllInputs();
+  bn->removeAllOutputs();
+  driver.erase(*bn);
+  driver.erase(*convY);
+
+  conv->addInput(*input);
+  conv->addInput(*newWeight);
+  conv->addInput(*newBias);
+  conv->addOutput(*outputY);
+
+  // The current ONNC IR graph status
+  // ================================
+  //
+  //    |        |           |
+  //  input  newWeight   newBias
+  //      \      |      /
+  //          (conv)
+  //            |
+  //         outputY
+  //            |
+}
+
+} // namespace foonvdla
+} // namespace onnc
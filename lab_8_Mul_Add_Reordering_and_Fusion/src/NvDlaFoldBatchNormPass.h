@@ -0,0 +1,43 @@
+//===- NvDlaFoldBatchNormPass.h -------------------------------------------===//
+//
+//                             The ONNC Project
+//
+// See LICENSE.TXT for details.
+//
+//===----------------------------------------------------------------------===//
+#ifndef ONNC_FOONVDLA_FOLD_BATCH_NORM_PASS_H
+#define ONNC_FOONVDLA_FOLD_BATCH_NORM_PASS_H
+#include "NvDlaPattern.h"
+#include "NvDlaRewriteDriver.h"
+
+#include <onnc/Core/CustomPass.h>
+
+namespace onnc {
+namespace foonvdla {
+
+/** \class NvDlaFoldBatchNormPass
+ *  \brief Fold an inference-mode BatchNormalization into the Conv before it.
+ *
+ *  With s = scale / sqrt(var + epsilon), the Conv weight W and bias b become
+ *  W * s and (b - mean) * s + B per output channel, so the BatchNormalization
+ *  costs no SDP operation. A Conv without bias gets one.
+ */
+class NvDlaFoldBatchNormPass : public CustomPass<NvDlaFoldBatchNormPass>
+{
+public:
+  NvDlaFoldBatchNormPass();
+
+  ReturnType runOnComputeGraph(ComputeGraph& pCG) override;
+
+private:
+  void fold(const NvDlaPatternMatch& match, NvDlaRewriteDriver& driver);
+
+  NvDlaPattern m_Pattern;
+
+  static unsigned tensorIdx;
+};
+
+} // namespace foonvdla
+} // namespace onnc
+
+#endif
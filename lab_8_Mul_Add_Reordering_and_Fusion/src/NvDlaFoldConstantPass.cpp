@@ -0,0 +1,247 @@
+//===- NvDlaFoldConstantPass.cpp ------------------------------------------===//
+//
+//                             The ONNC Project
+//
+// See LICENSE.TXT for details.
+//
+//===----------------------------------------------------------------------===//
+#include "NvDlaFoldConstantPass.h"
+
+#include "NvDlaBroadcast.h"
+#include "NvDlaPermutation.h"
+#include "NvDlaUtil.h"
+
+#include <onnc/Core/PassSupport.h>
+#include <onnc/IR/Compute/Add.h>
+#include <onnc/IR/Compute/Concat.h>
+#include <onnc/IR/Compute/Div.h>
+#include <onnc/IR/Compute/Flatten.h>
+#include <onnc/IR/Compute/Initializer.h>
+#include <onnc/IR/Compute/Mul.h>
+#include <onnc/IR/Compute/OutputOperator.h>
+#include <onnc/IR/Compute/Relu.h>
+#include <onnc/IR/Compute/Reshape.h>
+#include <onnc/IR/Compute/Squeeze.h>
+#include <onnc/IR/Compute/Sub.h>
+#include <onnc/IR/Compute/Transpose.h>
+#include <onnc/IR/Compute/Unsqueeze.h>
+#include <onnc/IR/ComputeOperator.h>
+
+#include <algorithm>
+#include <iterator>
+#include <cassert>
+#include <functional>
+#include <iostream>
+#include <string>
+#include <type_traits>
+#include <vector>
+
+namespace onnc {
+namespace foonvdla {
+
+namespace internal {
+
+using Dimensions = Tensor::Dimensions;
+
+bool isShapeOnly(const ComputeOperator& op)
+{
+  return isa<Reshape>(&op) || isa<Flatten>(&op) || isa<Squeeze>(&op) || isa<Unsqueeze>(&op);
+}
+
+template <typename TensorType>
+using ValueList = typename std::decay<decltype(std::declval<TensorType&>().getValues())>::type;
+
+/// The tensors whose values are read, the shape input of Reshape is not.
+std::vector<const Tensor*> getDataInputs(const ComputeOperator& op)
+{
+  std::vector<const Tensor*> inputs;
+  const unsigned             numOfInputs = (isa<Reshape>(&op) ? 1 : op.getNumOfInputs());
+  for (unsigned idx = 0; idx < numOfInputs; ++idx) {
+    inputs.emplace_back(dynamic_cast<const Tensor*>(op.getInput(idx)));
+  }
+  return inputs;
+}
+
+template <typename TensorType>
+bool hasValues(const std::vector<const Tensor*>& inputs)
+{
+  return std::all_of(inputs.begin(), inputs.end(), [](const Tensor* input) {
+    const TensorType* tensor = dynamic_cast<const TensorType*>(input);
+    return tensor != nullptr &&
+           tensor->getValues().size() == NvDlaBroadcast::getNumOfElements(tensor->getDimensions());
+  });
+}
+
+bool isFoldable(const ComputeOperator& op)
+{
+  if (op.getNumOfOutputs() != 1 || op.getNumOfInputs() == 0) {
+    return false;
+  }
+
+  for (unsigned idx = 0; idx < op.getNumOfInputs(); ++idx) {
+    const Tensor* input = dynamic_cast<const Tensor*>(op.getInput(idx));
+    if (input == nullptr || !isConstant(*input)) {
+      return false;
+    }
+  }
+
+  // keep the graph outputs defined by their operators
+  const Value* output = op.getOutput(0);
+  for (const auto& use : output->getUses()) {
+    if (isa<OutputOperator>(use.getUser())) {
+      return false;
+    }
+  }
+
+  const std::vector<const Tensor*> inputs = getDataInputs(op);
+  if (dynamic_cast<const FloatTensor*>(output) != nullptr) {
+    return hasValues<FloatTensor>(inputs);
+  } else if (dynamic_cast<const Int64Tensor*>(output) != nullptr) {
+    if (!hasValues<Int64Tensor>(inputs)) {
+      return false;
+    }
+
+    // integer division by zero is left to the runtime
+    const auto& divisors = static_cast<const Int64Tensor*>(inputs.back())->getValues();
+    return !isa<Div>(&op) || std::find(divisors.begin(), divisors.end(), 0) == divisors.end();
+  }
+  return false;
+}
+
+template <typename ValueListType, typename Function>
+void evaluateBinary(const Tensor& lhs, const ValueListType& lhsValues, const Tensor& rhs,
+                    const ValueListType& rhsValues, const Dimensions& outDims, ValueListType& result,
+                    Function function)
+{
+  const ValueListType lhsExpanded = NvDlaBroadcast::expand(lhsValues, lhs.getDimensions(), outDims);
+  const ValueListType rhsExpanded = NvDlaBroadcast::expand(rhsValues, rhs.getDimensions(), outDims);
+  std::transform(lhsExpanded.begin(), lhsExpanded.end(), rhsExpanded.begin(), std::back_inserter(result), function);
+}
+
+template <typename TensorType>
+void evaluate(const ComputeOperator& op, const Dimensions& outDims, ValueList<TensorType>& result)
+{
+  using Element = typename ValueList<TensorType>::value_type;
+
+  const std::vector<const Tensor*> inputs = getDataInputs(op);
+  const auto getValues = [&inputs](std::size_t idx) -> const ValueList<TensorType>& {
+    return static_cast<const TensorType*>(inputs[idx])->getValues();
+  };
+
+  if (isa<Add>(&op)) {
+    evaluateBinary(*inputs[0], getValues(0), *inputs[1], getValues(1), outDims, result, std::plus<Element>());
+  } else if (isa<Sub>(&op)) {
+    evaluateBinary(*inputs[0], getValues(0), *inputs[1], getValues(1), outDims, result, std::minus<Element>());
+  } else if (isa<Mul>(&op)) {
+    evaluateBinary(*inputs[0], getValues(0), *inputs[1], getValues(1), outDims, result, std::multiplies<Element>());
+  } else if (isa<Div>(&op)) {
+    evaluateBinary(*inputs[0], getValues(0), *inputs[1], getValues(1), outDims, result, std::divides<Element>());
+  } else if (isa<Relu>(&op)) {
+    for (Element value : getValues(0)) {
+      result.push_back(std::max(value, Element{0}));
+    }
+  } else if (isShapeOnly(op)) {
+    result = getValues(0);
+  } else if (const Transpose* transpose = dyn_cast<Transpose>(&op)) {
+    // the input axis perm[k] becomes the output axis k
+    const Dimensions&             inDims    = inputs[0]->getDimensions();
+    const NvDlaBroadcast::Strides inStrides = NvDlaBroadcast::getStrides(inDims, inDims.size());
+    const NvDlaPermutation::Axes  perm      = NvDlaPermutation::get(*transpose);
+    NvDlaBroadcast::Strides       strides(outDims.size(), 0);
+    for (std::size_t axis = 0; axis < outDims.size(); ++axis) {
+      strides[axis] = inStrides[perm.at(axis)];
+    }
+
+    NvDlaBroadcast::Index index(outDims.size(), 0);
+    const std::size_t     numOfElements = NvDlaBroadcast::getNumOfElements(outDims);
+    for (std::size_t count = 0; count < numOfElements; ++count) {
+      result.push_back(getValues(0)[NvDlaBroadcast::getOffset(index, strides)]);
+      NvDlaBroadcast::advance(index, outDims);
+    }
+  } else if (const Concat* concat = dyn_cast<Concat>(&op)) {
+    const std::int64_t rank = outDims.size();
+    const std::int64_t axis = (concat->getAxis().value() + rank) % rank;
+    const std::size_t  numOfOuters =
+      NvDlaBroadcast::getNumOfElements(Dimensions(outDims.begin(), outDims.begin() + axis));
+    for (std::size_t outer = 0; outer < numOfOuters; ++outer) {
+      for (std::size_t idx = 0; idx < inputs.size(); ++idx) {
+        const Dimensions& inDims = inputs[idx]->getDimensions();
+        const std::size_t chunk =
+          NvDlaBroadcast::getNumOfElements(Dimensions(inDims.begin() + axis, inDims.end()));
+        result.insert(result.end(), getValues(idx).begin() + outer * chunk,
+                      getValues(idx).begin() + (outer + 1) * chunk);
+      }
+    }
+  }
+}
+
+} // namespace internal
+
+//===----------------------------------------------------------------------===//
+// NvDlaFoldConstantPass
+//===----------------------------------------------------------------------===//
+unsigned NvDlaFoldConstantPass::tensorIdx = 0;
+
+Pass::ReturnType NvDlaFoldConstantPass::runOnComputeGraph(ComputeGraph& pCG)
+{
+  Pass::ReturnType ret = Pass::kModuleNoChanged;
+
+  const auto rewrite = [this](const NvDlaPatternMatch& match, NvDlaRewriteDriver& rewriter) {
+    fold(match, rewriter);
+  };
+
+  // Folding an operator makes its users constant-only, so the driver folds a
+  // whole subgraph of constants by the topological order.
+  NvDlaRewriteDriver driver(pCG);
+  driver.add(NvDlaPattern("FoldAdd").op<Add>().where(internal::isFoldable), rewrite)
+    .add(NvDlaPattern("FoldSub").op<Sub>().where(internal::isFoldable), rewrite)
+    .add(NvDlaPattern("FoldMul").op<Mul>().where(internal::isFoldable), rewrite)
+    .add(NvDlaPattern("FoldDiv").op<Div>().where(internal::isFoldable), rewrite)
+    .add(NvDlaPattern("FoldRelu").op<Relu>().where(internal::isFoldable), rewrite)
+    .add(NvDlaPattern("FoldConcat").op<Concat>().where(internal::isFoldable), rewrite)
+    .add(NvDlaPattern("FoldTranspose").op<Transpose>().where(internal::isFoldable), rewrite)
+    .add(NvDlaPattern("FoldReshape").op<Reshape>().where(internal::isFoldable), rewrite)
+    .add(NvDlaPattern("FoldFlatten").op<Flatten>().where(internal::isFoldable), rewrite)
+    .add(NvDlaPattern("FoldSqueeze").op<Squeeze>().where(internal::isFoldable), rewrite)
+    .add(NvDlaPattern("FoldUnsqueeze").op<Unsqueeze>().where(internal::isFoldable), rewrite);
+
+  const unsigned numOfFolded = driver.run();
+  if (numOfFolded != 0) {
+    std::cout << "NvDlaFoldConstantPass: folded " << numOfFolded << " operators\n";
+    ret |= Pass::kModuleChanged;
+  }
+
+  return ret;
+}
+
+void NvDlaFoldConstantPass::fold(const NvDlaPatternMatch& match, NvDlaRewriteDriver& driver)
+{
+  ComputeOperator* op     = match.operators[0];
+  Tensor*          output = op->getOutput(0);
+
+  // Create a new tensor and its Initializer, and compute the values.
+  Tensor* folded = dynamic_cast<Tensor*>(output->create());
+  folded->setName(output->getName() + "__folded_" + std::to_string(tensorIdx++));
+  folded->setDimensions(output->getDimensions());
+  if (FloatTensor* tensor = dynamic_cast<FloatTensor*>(folded)) {
+    internal::evaluate<FloatTensor>(*op, output->getDimensions(), tensor->getValues());
+    folded = driver.getGraph().addValue<FloatTensor>(tensor);
+  } else if (Int64Tensor* tensor = dynamic_cast<Int64Tensor*>(folded)) {
+    internal::evaluate<Int64Tensor>(*op, output->getDimensions(), tensor->getValues());
+    folded = driver.getGraph().addValue<Int64Tensor>(tensor);
+  }
+  assert((folded != nullptr) && "The name must be unique");
+
+  Initializer* initializer = driver.addOperator<Initializer>();
+  initializer->setTensor(*folded);
+
+  // Let the users read the folded tensor, and drop the operator.
+  output->replaceAllUsesWith(*folded);
+  op->removeAllInputs();
+  op->removeAllOutputs();
+  driver.erase(*op);
+  driver.erase(*output);
+}
+
+} // namespace foonvdla
+} // namespace onnc
@@ -0,0 +1,43 @@
+//===- NvDlaFoldConstantPass.h --------------------------------------------===//
+//
+//                             The ONNC Project
+//
+// See LICENSE.TXT for details.
+//
+//===----------------------------------------------------------------------===//
+#ifndef ONNC_FOONVDLA_FOLD_CONSTANT_PASS_H
+#define ONNC_FOONVDLA_FOLD_CONSTANT_PASS_H
+#include "NvDlaPattern.h"
+#include "NvDlaRewriteDriver.h"
+
+#include <onnc/Core/CustomPass.h>
+
+namespace onnc {
+namespace foonvdla {
+
+/** \class NvDlaFoldConstantPass
+ *  \brief Evaluate operators whose inputs are all constant at compile time.
+ *
+ *  Each folded operator is replaced by a new Initializer and tensor, so a
+ *  subgraph of constants collapses into one Initializer. Element-wise
+ *  Add/Sub/Mul/Div (with broadcasting), Relu, Concat, Transpose and the
+ *  shape-only Reshape/Flatten/Squeeze/Unsqueeze are folded, on float and
+ *  int64 tensors.
+ */
+class NvDlaFoldConstantPass : public CustomPass<NvDlaFoldConstantPass>
+{
+public:
+  NvDlaFoldConstantPass() = default;
+
+  ReturnType runOnComputeGraph(ComputeGraph& pCG) override;
+
+private:
+  void fold(const NvDlaPatternMatch& match, NvDlaRewriteDriver& driver);
+
+  static unsigned tensorIdx;
+};
+
+} // namespace foonvdla
+} // namespace onnc
+
+#endif
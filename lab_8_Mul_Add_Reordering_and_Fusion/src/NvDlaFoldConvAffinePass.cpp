@@ -0,0 +1,226 @@
+//===- NvDlaFoldConvAffinePass.cpp ----------------------------------------===//
+//
+//                             The ONNC Project
+//
+// See LICENSE.TXT for details.
+//
+//===----------------------------------------------------------------------===//
+#include "NvDlaFoldConvAffinePass.h"
+
+#include "NvDlaBroadcast.h"
+#include "NvDlaUtil.h"
+
+#include <onnc/Core/PassSupport.h>
+#include <onnc/IR/Compute/Add.h>
+#include <onnc/IR/Compute/Conv.h>
+#include <onnc/IR/Compute/Initializer.h>
+#include <onnc/IR/Compute/Mul.h>
+#include <onnc/IR/ComputeOperator.h>
+
+#include <cassert>
+#include <iostream>
+#include <string>
+#include <vector>
+
+namespace onnc {
+namespace foonvdla {
+
+namespace internal {
+
+/// The constant float tensor @ref tensor with all its values, or nullptr.
+const FloatTensor* getFullConstant(const Tensor* tensor)
+{
+  const FloatTensor* constant = dynamic_cast<const FloatTensor*>(tensor);
+  if (constant == nullptr || !isConstant(*constant) ||
+      constant->getValues().size() != NvDlaBroadcast::getNumOfElements(constant->getDimensions())) {
+    return nullptr;
+  }
+  return constant;
+}
+
+bool hasFoldableWeight(const ComputeOperator& op)
+{
+  const FloatTensor* weight = getFullConstant(op.getInput(1));
+  if (weight == nullptr || weight->getValues().empty() || op.getOutput(0)->getDimensions().size() != 4) {
+    return false;
+  }
+
+  const std::size_t numChannels = weight->dimension(0);
+  if (op.getNumOfInputs() < 3) {
+    return true;
+  }
+  const FloatTensor* bias = getFullConstant(op.getInput(2));
+  return bias != nullptr && bias->getValues().size() == numChannels;
+}
+
+/// The constant operand of a Mul or Add after a Conv, if it is per layer or per
+/// channel of the Conv output, or nullptr.
+const FloatTensor* getChannelConstant(const ComputeOperator& op)
+{
+  if (op.getNumOfInputs() != 2) {
+    return nullptr;
+  }
+
+  const unsigned     idx      = (isa<Conv>(static_cast<ComputeOperator*>(op.getInput(0)->getDefine())) ? 1 : 0);
+  const FloatTensor* constant = getFullConstant(op.getInput(idx));
+  if (constant == nullptr) {
+    return nullptr;
+  }
+
+  // the result keeps the Conv output shape, and only the channel axis varies
+  const Tensor::Dimensions& outDims   = op.getInput(1 - idx)->getDimensions();
+  const Tensor::Dimensions& constDims = constant->getDimensions();
+  Tensor::Dimensions        dims;
+  if (!NvDlaBroadcast::getDimensions(outDims, constDims, dims) || dims != outDims) {
+    return nullptr;
+  }
+  for (std::size_t axis = 0; axis < constDims.size(); ++axis) {
+    const std::size_t outAxis = outDims.size() - constDims.size() + axis;
+    if (outAxis != 1 && constDims[axis] != 1) {
+      return nullptr;
+    }
+  }
+  return constant;
+}
+
+bool isChannelAffine(const ComputeOperator& op) { return getChannelConstant(op) != nullptr; }
+
+} // namespace internal
+
+//===----------------------------------------------------------------------===//
+// NvDlaFoldConvAffinePass
+//===----------------------------------------------------------------------===//
+unsigned NvDlaFoldConvAffinePass::tensorIdx = 0;
+
+NvDlaFoldConvAffinePass::NvDlaFoldConvAffinePass()
+  : m_MulPattern{NvDlaPattern("ConvMul")
+                   .op<Conv>()
+                   .singleUse()
+                   .where(internal::hasFoldableWeight)
+                   .op<Mul>()
+                   .where(internal::isChannelAffine)}
+  , m_AddPattern{NvDlaPattern("ConvAdd")
+                   .op<Conv>()
+                   .singleUse()
+                   .where(internal::hasFoldableWeight)
+                   .op<Add>()
+                   .where(internal::isChannelAffine)}
+{
+  // The Conv result must only be scaled or shifted, since its values change.
+}
+
+Pass::ReturnType NvDlaFoldConvAffinePass::runOnComputeGraph(ComputeGraph& pCG)
+{
+  Pass::ReturnType ret = Pass::kModuleNoChanged;
+
+  // The folded Conv is revisited, so a following Add and Mul are both folded.
+  NvDlaRewriteDriver driver(pCG);
+  for (const NvDlaPattern* pattern : {&m_MulPattern, &m_AddPattern}) {
+    driver.add(*pattern, [this](const NvDlaPatternMatch& match, NvDlaRewriteDriver& rewriter) {
+      fold(match, rewriter);
+    });
+  }
+
+  const unsigned numOfFolded = driver.run();
+  if (numOfFolded != 0) {
+    std::cout << "NvDlaFoldConvAffinePass: folded " << numOfFolded << " Mul/Add into Conv\n";
+    ret |= Pass::kModuleChanged;
+  }
+
+  return ret;
+}
+
+void NvDlaFoldConvAffinePass::fold(const NvDlaPatternMatch& match, NvDlaRewriteDriver& driver)
+{
+  Conv*            conv   = dyn_cast<Conv>(match.operators[0]);
+  ComputeOperator* affine = match.operators[1];
+  const bool       isMul  = isa<Mul>(affine);
+
+  Tensor*            input    = conv->getInput(0);
+  FloatTensor*       weight   = dynamic_cast<FloatTensor*>(conv->getInput(1));
+  FloatTensor*       bias     = (conv->getNumOfInputs() < 3 ? nullptr : dynamic_cast<FloatTensor*>(conv->getInput(2)));
+  Tensor*            convY    = conv->getOutput(0);
+  Tensor*            outputY  = affine->getOutput(0);
+  const FloatTensor* constant = internal::getChannelConstant(*affine);
+
+  // Create the folded weight and bias, the original ones may be shared. The
+  // weight is only changed by a Mul.
+  const std::string suffix      = (isMul ? "__scale_" : "__shift_") + std::to_string(tensorIdx++);
+  const std::size_t numChannels = weight->dimension(0);
+  const std::size_t kernelSize  = weight->getValues().size() / numChannels;
+
+  FloatTensor* newWeight = weight;
+  if (isMul) {
+    newWeight = dynamic_cast<FloatTensor*>(weight->create());
+    newWeight->setName(weight->getName() + suffix);
+    newWeight->setDimensions(weight->getDimensions());
+  }
+
+  FloatTensor* newBias = dynamic_cast<FloatTensor*>(weight->create());
+  newBias->setName((bias != nullptr ? bias->getName() : convY->getName() + "_bias") + suffix);
+  newBias->setDimensions({static_cast<Tensor::Dimension>(numChannels)});
+
+  const std::vector<float>& values = constant->getValues();
+  for (std::size_t channel = 0; channel < numChannels; ++channel) {
+    const float k       = values[values.size() == 1 ? 0 : channel];
+    const float oldBias = (bias != nullptr ? bias->getValues()[channel] : 0.0f);
+    if (isMul) {
+      for (std::size_t idx = 0; idx < kernelSize; ++idx) {
+        newWeight->getValues().push_back(weight->getValues()[channel * kernelSize + idx] * k);
+      }
+      newBias->getValues().push_back(oldBias * k);
+    } else {
+      newBias->getValues().push_back(oldBias + k);
+    }
+  }
+
+  if (isMul) {
+    newWeight = driver.getGraph().addValue<FloatTensor>(newWeight);
+    assert((newWeight != nullptr) && "The name must be unique");
+    driver.addOperator<Initializer>()->setTensor(*newWeight);
+  }
+  newBias = driver.getGraph().addValue<FloatTensor>(newBias);
+  assert((newBias != nullptr) && "The name must be unique");
+  driver.addOperator<Initializer>()->setTensor(*newBias);
+
+  // The current ONNC IR graph status
+  // ================================
+  //
+  //    |      |       |
+  //  input  weight  (bias)
+  //      \    |    /
+  //        (conv)
+  //          |
+  //        convY   constant
+  //           \     /
+  //          (mul/add)
+  //             |
+  //          outputY
+  //             |
+
+  conv->removeAllInputs();
+  conv->removeAllOutputs();
+  affine->removeAllInputs();
+  affine->removeAllOutputs();
+  driver.erase(*affine);
+  driver.erase(*convY);
+
+  conv->addInput(*input);
+  conv->addInput(*newWeight);
+  conv->addInput(*newBias);
+  conv->addOutput(*outputY);
+
+  // The current ONNC IR graph status
+  // ================================
+  //
+  //    |        |           |
+  //  input  newWeight   newBias
+  //      \      |      /
+  //          (conv)
+  //            |
+  //         outputY
+  //            |
+}
+
+} // namespace foonvdla
+} // namespace onnc
@@ -0,0 +1,45 @@
+//===- NvDlaFoldConvAffinePass.h ------------------------------------------===//
+//
+//                             The ONNC Project
+//
+// See LICENSE.TXT for details.
+//
+//===----------------------------------------------------------------------===//
+#ifndef ONNC_FOONVDLA_FOLD_CONV_AFFINE_PASS_H
+#define ONNC_FOONVDLA_FOLD_CONV_AFFINE_PASS_H
+#include "NvDlaPattern.h"
+#include "NvDlaRewriteDriver.h"
+
+#include <onnc/Core/CustomPass.h>
+
+namespace onnc {
+namespace foonvdla {
+
+/** \class NvDlaFoldConvAffinePass
+ *  \brief Fold a constant Mul or Add right after a Conv into its weight and bias.
+ *
+ *  A per-layer or per-channel multiplier a turns the weight W and bias b into
+ *  W * a and b * a, and an addend c turns b into b + c, so the packed weight
+ *  and bias already contain them and no SDP operation is emitted. It runs
+ *  after NvDlaReorderMulAddPass, which leaves at most an Add and a Mul.
+ */
+class NvDlaFoldConvAffinePass : public CustomPass<NvDlaFoldConvAffinePass>
+{
+public:
+  NvDlaFoldConvAffinePass();
+
+  ReturnType runOnComputeGraph(ComputeGraph& pCG) override;
+
+private:
+  void fold(const NvDlaPatternMatch& match, NvDlaRewriteDriver& driver);
+
+  NvDlaPattern m_MulPattern;
+  NvDlaPattern m_AddPattern;
+
+  static unsigned tensorIdx;
+};
+
+} // namespace foonvdla
+} // namespace onnc
+
+#endif
@@ -0,0 +1,250 @@
+//===- NvDlaFoldPadTransposePass.cpp --------------------------------------===//
+//
+//                             The ONNC Project
+//
+// See LICENSE.TXT for details.
+//
+//===----------------------------------------------------------------------===//
+#include "NvDlaFoldPadTransposePass.h"
+
+#include "NvDlaPermutation.h"
+
+#include <onnc/Core/PassSupport.h>
+#include <onnc/IR/Compute/Conv.h>
+#include <onnc/IR/Compute/Initializer.h>
+#include <onnc/IR/Compute/OutputOperator.h>
+#include <onnc/IR/Compute/Pad.h>
+#include <onnc/IR/Compute/Reshape.h>
+#include <onnc/IR/Compute/Transpose.h>
+#include <onnc/IR/ComputeOperator.h>
+
+#include <cassert>
+#include <cstdint>
+#include <iostream>
+#include <string>
+#include <vector>
+
+namespace onnc {
+namespace foonvdla {
+
+namespace internal {
+
+// The CONV padding fields of NVDLA hold 5 bits.
+constexpr std::int64_t kMaxConvPad = 31;
+
+bool isGraphOutput(const Value& value)
+{
+  for (const auto& use : value.getUses()) {
+    if (isa<OutputOperator>(use.getUser())) {
+      return true;
+    }
+  }
+  return false;
+}
+
+/// Conv padding [top, left, bottom, right] added by a zero Pad of the spatial axes.
+bool getSpatialPads(const Pad& pad, std::vector<std::int64_t>& pads)
+{
+  const std::vector<std::int64_t>& padPads = pad.getPads().vector();
+  if (pad.getInput(0)->getNumOfDimensions() != 4 || padPads.size() != 8 || pad.getMode().value() != "constant" ||
+      pad.getValue().value() != 0.0f) {
+    return false;
+  }
+  for (unsigned axis : {0, 1, 4, 5}) {
+    if (padPads[axis] != 0) {
+      return false;
+    }
+  }
+
+  pads = {padPads[2], padPads[3], padPads[6], padPads[7]};
+  for (std::int64_t value : pads) {
+    if (value < 0) {
+      return false;
+    }
+  }
+  return true;
+}
+
+/// The Pad only read by @ref conv as its data input, or nullptr.
+Pad* getPadInput(const Conv& conv)
+{
+  Pad* pad = dyn_cast<Pad>(static_cast<ComputeOperator*>(conv.getInput(0)->getDefine()));
+  if (pad == nullptr || pad->getOutput(0)->getUses().size() != 1) {
+    return nullptr;
+  }
+  return pad;
+}
+
+/// Conv padding after the Pad before it is folded.
+bool getFoldedPads(const Conv& conv, std::vector<std::int64_t>& pads)
+{
+  const Pad* pad = getPadInput(conv);
+  if (pad == nullptr || !getSpatialPads(*pad, pads)) {
+    return false;
+  }
+
+  const std::string& autoPad = conv.getAutoPad().value();
+  if (!autoPad.empty() && autoPad != "NOTSET") {
+    return false;
+  }
+
+  const std::vector<std::int64_t>& convPads = conv.getPads().vector();
+  for (std::size_t idx = 0; idx < pads.size(); ++idx) {
+    pads[idx] += (convPads.size() == pads.size() ? convPads[idx] : 0);
+    if (pads[idx] > kMaxConvPad) {
+      return false;
+    }
+  }
+  return true;
+}
+
+bool isPadFoldable(const ComputeOperator& op)
+{
+  std::vector<std::int64_t> pads;
+  return getFoldedPads(*dyn_cast<Conv>(&op), pads);
+}
+
+bool movesUnitAxesOnly(const ComputeOperator& op)
+{
+  const Transpose&             transpose = *dyn_cast<Transpose>(&op);
+  const Tensor::Dimensions&    dims      = transpose.getInput(0)->getDimensions();
+  const NvDlaPermutation::Axes perm      = NvDlaPermutation::get(transpose);
+  if (perm.size() != dims.size() || NvDlaPermutation::isIdentity(perm)) {
+    return false;
+  }
+
+  // NVDLA packs the channels of a feature cube into atoms, so the bytes only
+  // stay in place if N and C do and a unit axis moves between H and W
+  if (dims.size() != 4 || perm[0] != 0 || perm[1] != 1) {
+    return false;
+  }
+
+  // the other axes keep their order, so do the elements
+  std::int64_t last = -1;
+  for (std::int64_t axis : perm) {
+    if (dims[axis] == 1) {
+      continue;
+    }
+    if (axis < last) {
+      return false;
+    }
+    last = axis;
+  }
+  return true;
+}
+
+} // namespace internal
+
+//===----------------------------------------------------------------------===//
+// NvDlaFoldPadTransposePass
+//===----------------------------------------------------------------------===//
+unsigned NvDlaFoldPadTransposePass::tensorIdx = 0;
+
+Pass::ReturnType NvDlaFoldPadTransposePass::runOnComputeGraph(ComputeGraph& pCG)
+{
+  Pass::ReturnType ret = Pass::kModuleNoChanged;
+
+  // Transpose pairs are tried first, so a chain of Transposes is merged
+  // before what is left is turned into a Reshape.
+  NvDlaRewriteDriver driver(pCG);
+  driver
+    .add(NvDlaPattern("PadConv").op<Pad>().singleUse().op<Conv>().where(internal::isPadFoldable),
+         [this](const NvDlaPatternMatch& match, NvDlaRewriteDriver& rewriter) { foldPad(match, rewriter); })
+    .add(NvDlaPattern("TransposeTranspose").op<Transpose>().singleUse().op<Transpose>(),
+         [this](const NvDlaPatternMatch& match, NvDlaRewriteDriver& rewriter) { foldTransposes(match, rewriter); })
+    .add(NvDlaPattern("UnitTranspose").op<Transpose>().where(internal::movesUnitAxesOnly),
+         [this](const NvDlaPatternMatch& match, NvDlaRewriteDriver& rewriter) { reshapeTranspose(match, rewriter); });
+
+  const unsigned numOfFolded = driver.run();
+  if (numOfFolded != 0) {
+    std::cout << "NvDlaFoldPadTransposePass: removed " << numOfFolded << " Pad/Transpose\n";
+    ret |= Pass::kModuleChanged;
+  }
+
+  return ret;
+}
+
+void NvDlaFoldPadTransposePass::foldPad(const NvDlaPatternMatch& match, NvDlaRewriteDriver& driver)
+{
+  // The matched Pad may be a weight input, the data input is folded.
+  Conv* conv = dyn_cast<Conv>(match.operators[1]);
+  Pad*  pad  = internal::getPadInput(*conv);
+
+  std::vector<std::int64_t> pads;
+  internal::getFoldedPads(*conv, pads);
+  conv->setPads(IntsAttr(pads));
+
+  // The Conv reads the Pad input in place of its output.
+  Tensor* padded = pad->getOutput(0);
+  padded->replaceAllUsesWith(*pad->getInput(0));
+  pad->removeAllInputs();
+  pad->removeAllOutputs();
+  driver.erase(*pad);
+  driver.erase(*padded);
+}
+
+void NvDlaFoldPadTransposePass::foldTransposes(const NvDlaPatternMatch& match, NvDlaRewriteDriver& driver)
+{
+  Transpose* first  = dyn_cast<Transpose>(match.operators[0]);
+  Transpose* second = dyn_cast<Transpose>(match.operators[1]);
+
+  // Axis i of the result is axis perm1[perm2[i]] of the input.
+  const NvDlaPermutation::Axes perm1 = NvDlaPermutation::get(*first);
+  const NvDlaPermutation::Axes perm2 = NvDlaPermutation::get(*second);
+  NvDlaPermutation::Axes       perm;
+  for (std::int64_t axis : perm2) {
+    perm.emplace_back(perm1[axis]);
+  }
+
+  Tensor* input  = first->getInput(0);
+  Tensor* middle = first->getOutput(0);
+  Tensor* output = second->getOutput(0);
+  first->removeAllInputs();
+  first->removeAllOutputs();
+  driver.erase(*first);
+  driver.erase(*middle);
+
+  // A graph output keeps its name, so it is still written by a Transpose.
+  if (NvDlaPermutation::isIdentity(perm) && !internal::isGraphOutput(*output)) {
+    output->replaceAllUsesWith(*input);
+    second->removeAllInputs();
+    second->removeAllOutputs();
+    driver.erase(*second);
+    driver.erase(*output);
+    return;
+  }
+
+  second->removeAllInputs();
+  second->addInput(*input);
+  second->setPerm(IntsAttr(perm));
+}
+
+void NvDlaFoldPadTransposePass::reshapeTranspose(const NvDlaPatternMatch& match, NvDlaRewriteDriver& driver)
+{
+  Transpose* transpose = dyn_cast<Transpose>(match.operators[0]);
+  Tensor*    input     = transpose->getInput(0);
+  Tensor*    output    = transpose->getOutput(0);
+
+  // Create the shape tensor of the Reshape.
+  Int64Tensor* shape = new Int64Tensor();
+  shape->setName(output->getName() + "__shape_" + std::to_string(tensorIdx++));
+  shape->setDimensions({static_cast<Tensor::Dimension>(output->getNumOfDimensions())});
+  for (Tensor::Dimension dim : output->getDimensions()) {
+    shape->getValues().push_back(dim);
+  }
+  shape = driver.getGraph().addValue<Int64Tensor>(shape);
+  assert((shape != nullptr) && "The name must be unique");
+  driver.addOperator<Initializer>()->setTensor(*shape);
+
+  transpose->removeAllInputs();
+  transpose->removeAllOutputs();
+  driver.erase(*transpose);
+
+  Reshape* reshape = driver.addOperator<Reshape>();
+  reshape->addInput(*input);
+  reshape->addInput(*shape);
+  reshape->addOutput(*output);
+}
+
+} // namespace foonvdla
+} // namespace onnc
@@ -0,0 +1,47 @@
+//===- NvDlaFoldPadTransposePass.h ----------------------------------------===//
+//
+//                             The ONNC Project
+//
+// See LICENSE.TXT for details.
+//
+//===----------------------------------------------------------------------===//
+#ifndef ONNC_FOONVDLA_FOLD_PAD_TRANSPOSE_PASS_H
+#define ONNC_FOONVDLA_FOLD_PAD_TRANSPOSE_PASS_H
+#include "NvDlaPattern.h"
+#include "NvDlaRewriteDriver.h"
+
+#include <onnc/Core/CustomPass.h>
+
+namespace onnc {
+namespace foonvdla {
+
+/** \class NvDlaFoldPadTransposePass
+ *  \brief Remove Pad and Transpose operators which only move data.
+ *
+ *  A zero Pad of the spatial axes before a Conv becomes the Conv padding.
+ *  Two Transposes in a row become one, or none if they cancel out. A
+ *  Transpose which only moves a unit axis between H and W keeps the bytes of
+ *  the feature cube, so it becomes a Reshape, which NvDlaMemInfoPass maps to
+ *  the memory of its input.
+ */
+class NvDlaFoldPadTransposePass : public CustomPass<NvDlaFoldPadTransposePass>
+{
+public:
+  NvDlaFoldPadTransposePass() = default;
+
+  ReturnType runOnComputeGraph(ComputeGraph& pCG) override;
+
+private:
+  void foldPad(const NvDlaPatternMatch& match, NvDlaRewriteDriver& driver);
+
+  void foldTransposes(const NvDlaPatternMatch& match, NvDlaRewriteDriver& driver);
+
+  void reshapeTranspose(const NvDlaPatternMatch& match, NvDlaRewriteDriver& driver);
+
+  static unsigned tensorIdx;
+};
+
+} // namespace foonvdla
+} // namespace onnc
+
+#endif
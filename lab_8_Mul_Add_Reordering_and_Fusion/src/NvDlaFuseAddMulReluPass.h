@@ -7,8 +7,10 @@
 //===----------------------------------------------------------------------===//
 #ifndef ONNC_FOONVDLA_FUSE_ADD_MUL_RELU_PASS_H
 #define ONNC_FOONVDLA_FUSE_ADD_MUL_RELU_PASS_H
-#include <onnc/Core/CustomPass.h>
+#include "NvDlaPattern.h"
+#include "NvDlaRewriteDriver.h"
 
+#include <onnc/Core/CustomPass.h>
 
 namespace onnc {
 namespace foonvdla {
@@ -16,14 +18,14 @@ namespace foonvdla {
 class NvDlaFuseAddMulReluPass : public CustomPass<NvDlaFuseAddMulReluPass>
 {
 public:
-  NvDlaFuseAddMulReluPass() = default;
-
-  ReturnType runOnModule(Module& pModule) override;
+  NvDlaFuseAddMulReluPass();
 
   ReturnType runOnComputeGraph(ComputeGraph& pCG) override;
 
 private:
-  bool isAddMulRelu(ComputeOperator* pNode);
+  void fuse(const NvDlaPatternMatch& match, NvDlaRewriteDriver& driver);
+
+  NvDlaPattern m_Pattern;
 };
 
 } // namespace foonvdla
@@ -0,0 +1,376 @@
+//===- NvDlaIRSnapshot.cpp ------------------------------------------------===//
+//
+//                             The ONNC Project
+//
+// See LICENSE.TXT for details.
+//
+//===----------------------------------------------------------------------===//
+#include "NvDlaIRSnapshot.h"
+
+#include <onnc/IR/Compute/Tensor.h>
+
+#include <algorithm>
+#include <map>
+#include <sstream>
+#include <unordered_map>
+
+namespace onnc {
+namespace foonvdla {
+
+namespace internal {
+
+const char kSnapshotMagic[4] = {'N', 'V', 'I', 'R'};
+
+void writeVarint(std::ostream& os, std::uint64_t value)
+{
+  do {
+    const unsigned char byte = value & 0x7f;
+    value >>= 7;
+    os.put(static_cast<char>(value != 0 ? (byte | 0x80) : byte));
+  } while (value != 0);
+}
+
+bool readVarint(std::istream& is, std::uint64_t& value)
+{
+  value = 0;
+  for (unsigned shift = 0; shift < 64; shift += 7) {
+    const int byte = is.get();
+    if (byte == std::istream::traits_type::eof()) {
+      return false;
+    }
+    value |= static_cast<std::uint64_t>(byte & 0x7f) << shift;
+    if ((byte & 0x80) == 0) {
+      return true;
+    }
+  }
+  return false;
+}
+
+/// Bytes left in @ref is, 0 if it can not tell.
+std::uint64_t getRemainingBytes(std::istream& is)
+{
+  const std::istream::pos_type current = is.tellg();
+  if (current == std::istream::pos_type(-1)) {
+    return 0;
+  }
+  is.seekg(0, std::ios::end);
+  const std::istream::pos_type end = is.tellg();
+  is.seekg(current);
+  return (end == std::istream::pos_type(-1) || end < current ? 0 : static_cast<std::uint64_t>(end - current));
+}
+
+/// Read the # of entries or bytes which follow. Every one of them takes a
+/// byte at least, so a corrupted size fails here before it is allocated.
+bool readSize(std::istream& is, std::uint64_t& size)
+{
+  return readVarint(is, size) && size <= getRemainingBytes(is);
+}
+
+/// Read a varint which indexes a table of @ref size entries.
+bool readIndex(std::istream& is, std::size_t size, unsigned& index)
+{
+  std::uint64_t value = 0;
+  if (!readVarint(is, value) || value >= size) {
+    return false;
+  }
+  index = static_cast<unsigned>(value);
+  return true;
+}
+
+/// Operators are matched by kind and output names, the results of an
+/// operator keep their names when the pass before rewrites it.
+std::string getSnapshotKey(const NvDlaIRSnapshot& snapshot, const NvDlaIRSnapshot::OperatorInfo& op)
+{
+  // an OutputOperator has no outputs, its inputs name it
+  const std::vector<unsigned>& values = (op.outputs.empty() ? op.inputs : op.outputs);
+
+  std::string key = op.kind + "(";
+  for (std::size_t idx = 0; idx < values.size(); ++idx) {
+    key += (idx == 0 ? "" : ", ") + snapshot.getValues()[values[idx]].name;
+  }
+  return key + ")";
+}
+
+std::string getSnapshotSignature(const NvDlaIRSnapshot& snapshot, const NvDlaIRSnapshot::OperatorInfo& op)
+{
+  std::ostringstream os;
+  os << op.attributes << " (";
+  for (std::size_t idx = 0; idx < op.inputs.size(); ++idx) {
+    os << (idx == 0 ? "" : ", ") << snapshot.getValues()[op.inputs[idx]].name;
+  }
+  os << ") -> [";
+  for (std::size_t idx = 0; idx < op.outputs.size(); ++idx) {
+    os << (idx == 0 ? "" : ", ");
+    const std::vector<std::int64_t>& dims = snapshot.getValues()[op.outputs[idx]].dims;
+    for (std::size_t axis = 0; axis < dims.size(); ++axis) {
+      os << (axis == 0 ? "" : "x") << dims[axis];
+    }
+  }
+  os << "]";
+  return os.str();
+}
+
+} // namespace internal
+
+//===----------------------------------------------------------------------===//
+// NvDlaIRPrintOptions
+//===----------------------------------------------------------------------===//
+bool NvDlaIRPrintOptions::isPrintedBefore(const std::string& passName) const
+{
+  return std::find(printBefore.begin(), printBefore.end(), passName) != printBefore.end() ||
+         std::find(printBefore.begin(), printBefore.end(), "*") != printBefore.end();
+}
+
+bool NvDlaIRPrintOptions::isPrintedAfter(const std::string& passName) const
+{
+  return std::find(printAfter.begin(), printAfter.end(), passName) != printAfter.end() ||
+         std::find(printAfter.begin(), printAfter.end(), "*") != printAfter.end();
+}
+
+bool NvDlaIRPrintOptions::isPrinted(const ComputeOperator& op) const
+{
+  return opKinds.empty() || std::find(opKinds.begin(), opKinds.end(), op.name().str()) != opKinds.end();
+}
+
+std::vector<std::string> NvDlaIRPrintOptions::split(const std::string& list)
+{
+  std::vector<std::string> items;
+  std::istringstream       is(list);
+  std::string              item;
+  while (std::getline(is, item, ',')) {
+    if (!item.empty()) {
+      items.emplace_back(item);
+    }
+  }
+  return items;
+}
+
+//===----------------------------------------------------------------------===//
+// NvDlaIRSnapshot
+//===----------------------------------------------------------------------===//
+NvDlaIRSnapshot NvDlaIRSnapshot::take(ComputeGraph& pCG, const NvDlaIRPrintOptions& options)
+{
+  NvDlaIRSnapshot                            snapshot;
+  std::unordered_map<const Value*, unsigned> indices;
+
+  auto getIndex = [&snapshot, &indices](const Value* value) {
+    const auto found = indices.find(value);
+    if (found != indices.end()) {
+      return found->second;
+    }
+
+    ValueInfo info;
+    info.name = value->getName();
+    if (const Tensor* tensor = dynamic_cast<const Tensor*>(value)) {
+      info.dims = tensor->getDimensions();
+    }
+    const unsigned index = static_cast<unsigned>(snapshot.m_Values.size());
+    snapshot.m_Values.emplace_back(info);
+    indices.emplace(value, index);
+    return index;
+  };
+
+  for (ComputeOperator& op : pCG) {
+    if (!options.isPrinted(op)) {
+      continue;
+    }
+
+    OperatorInfo info;
+    info.kind = op.name().str();
+
+    std::ostringstream attributes;
+    op.printAttributes(attributes);
+    info.attributes = attributes.str();
+
+    for (unsigned idx = 0; idx < op.getNumOfInputs(); ++idx) {
+      info.inputs.emplace_back(getIndex(op.getInput(idx)));
+    }
+    for (unsigned idx = 0; idx < op.getNumOfOutputs(); ++idx) {
+      info.outputs.emplace_back(getIndex(op.getOutput(idx)));
+    }
+    snapshot.m_Operators.emplace_back(info);
+  }
+
+  return snapshot;
+}
+
+void NvDlaIRSnapshot::write(std::ostream& os) const
+{
+  using internal::writeVarint;
+
+  // Names, kinds and attributes repeat a lot, they are written once.
+  std::vector<const std::string*>      strings;
+  std::map<std::string, std::uint64_t> stringIds;
+  auto getStringId = [&strings, &stringIds](const std::string& text) {
+    const auto result = stringIds.emplace(text, strings.size());
+    if (result.second) {
+      strings.emplace_back(&result.first->first);
+    }
+    return result.first->second;
+  };
+  for (const ValueInfo& value : m_Values) {
+    getStringId(value.name);
+  }
+  for (const OperatorInfo& op : m_Operators) {
+    getStringId(op.kind);
+    getStringId(op.attributes);
+  }
+
+  os.write(internal::kSnapshotMagic, sizeof(internal::kSnapshotMagic));
+  writeVarint(os, VERSION);
+
+  writeVarint(os, strings.size());
+  for (const std::string* text : strings) {
+    writeVarint(os, text->size());
+    os.write(text->data(), text->size());
+  }
+
+  writeVarint(os, m_Values.size());
+  for (const ValueInfo& value : m_Values) {
+    writeVarint(os, stringIds.at(value.name));
+    writeVarint(os, value.dims.size());
+    for (std::int64_t dim : value.dims) {
+      // zigzag, an unknown dimension may be negative
+      writeVarint(os, (static_cast<std::uint64_t>(dim) << 1) ^ static_cast<std::uint64_t>(dim >> 63));
+    }
+  }
+
+  writeVarint(os, m_Operators.size());
+  for (const OperatorInfo& op : m_Operators) {
+    writeVarint(os, stringIds.at(op.kind));
+    writeVarint(os, stringIds.at(op.attributes));
+    writeVarint(os, op.inputs.size());
+    for (unsigned index : op.inputs) {
+      writeVarint(os, index);
+    }
+    writeVarint(os, op.outputs.size());
+    for (unsigned index : op.outputs) {
+      writeVarint(os, index);
+    }
+  }
+}
+
+bool NvDlaIRSnapshot::read(std::istream& is, NvDlaIRSnapshot& snapshot)
+{
+  using internal::readIndex;
+  using internal::readSize;
+  using internal::readVarint;
+
+  char magic[sizeof(internal::kSnapshotMagic)];
+  if (!is.read(magic, sizeof(magic)) || !std::equal(magic, magic + sizeof(magic), internal::kSnapshotMagic)) {
+    return false;
+  }
+
+  std::uint64_t version = 0, size = 0;
+  if (!readVarint(is, version) || version != VERSION || !readSize(is, size)) {
+    return false;
+  }
+
+  std::vector<std::string> strings(size);
+  for (std::string& text : strings) {
+    if (!readSize(is, size)) {
+      return false;
+    }
+    text.resize(size);
+    if (!is.read(&text[0], size)) {
+      return false;
+    }
+  }
+
+  snapshot.m_Values.clear();
+  snapshot.m_Operators.clear();
+
+  if (!readSize(is, size)) {
+    return false;
+  }
+  snapshot.m_Values.resize(size);
+  for (ValueInfo& value : snapshot.m_Values) {
+    unsigned      name = 0;
+    std::uint64_t rank = 0;
+    if (!readIndex(is, strings.size(), name) || !readSize(is, rank)) {
+      return false;
+    }
+    value.name = strings[name];
+    value.dims.reserve(rank);
+    for (std::uint64_t axis = 0; axis < rank; ++axis) {
+      std::uint64_t dim = 0;
+      if (!readVarint(is, dim)) {
+        return false;
+      }
+      value.dims.emplace_back(static_cast<std::int64_t>(dim >> 1) ^ -static_cast<std::int64_t>(dim & 1));
+    }
+  }
+
+  if (!readSize(is, size)) {
+    return false;
+  }
+  snapshot.m_Operators.resize(size);
+  for (OperatorInfo& op : snapshot.m_Operators) {
+    unsigned kind = 0, attributes = 0;
+    if (!readIndex(is, strings.size(), kind) || !readIndex(is, strings.size(), attributes)) {
+      return false;
+    }
+    op.kind       = strings[kind];
+    op.attributes = strings[attributes];
+
+    for (std::vector<unsigned>* values : {&op.inputs, &op.outputs}) {
+      if (!readSize(is, size)) {
+        return false;
+      }
+      values->resize(size);
+      for (unsigned& index : *values) {
+        if (!readIndex(is, snapshot.m_Values.size(), index)) {
+          return false;
+        }
+      }
+    }
+  }
+
+  return true;
+}
+
+unsigned NvDlaIRSnapshot::diff(const NvDlaIRSnapshot& from, const NvDlaIRSnapshot& to, std::ostream& os)
+{
+  using internal::getSnapshotKey;
+  using internal::getSnapshotSignature;
+
+  std::unordered_map<std::string, const OperatorInfo*> toOps;
+  for (const OperatorInfo& op : to.m_Operators) {
+    toOps.emplace(getSnapshotKey(to, op), &op);
+  }
+
+  unsigned numOfDiffs = 0;
+
+  std::unordered_map<std::string, const OperatorInfo*> fromOps;
+  for (const OperatorInfo& op : from.m_Operators) {
+    const std::string key = getSnapshotKey(from, op);
+    fromOps.emplace(key, &op);
+
+    const auto found = toOps.find(key);
+    if (found == toOps.end()) {
+      os << "- " << key << "\n";
+      ++numOfDiffs;
+      continue;
+    }
+
+    const std::string before = getSnapshotSignature(from, op);
+    const std::string after  = getSnapshotSignature(to, *found->second);
+    if (before != after) {
+      os << "~ " << key << ": " << before << " => " << after << "\n";
+      ++numOfDiffs;
+    }
+  }
+
+  for (const OperatorInfo& op : to.m_Operators) {
+    const std::string key = getSnapshotKey(to, op);
+    if (fromOps.find(key) == fromOps.end()) {
+      os << "+ " << key << "\n";
+      ++numOfDiffs;
+    }
+  }
+
+  return numOfDiffs;
+}
+
+} // namespace foonvdla
+} // namespace onnc
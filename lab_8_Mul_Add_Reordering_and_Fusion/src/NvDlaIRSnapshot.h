@@ -0,0 +1,109 @@
+//===- NvDlaIRSnapshot.h --------------------------------------------------===//
+//
+//                             The ONNC Project
+//
+// See LICENSE.TXT for details.
+//
+//===----------------------------------------------------------------------===//
+#ifndef TARGET_FOONVDLA_NVDLA_IR_SNAPSHOT_H
+#define TARGET_FOONVDLA_NVDLA_IR_SNAPSHOT_H
+
+#include <onnc/IR/ComputeGraph.h>
+#include <onnc/IR/ComputeOperator.h>
+
+#include <cstdint>
+#include <istream>
+#include <ostream>
+#include <string>
+#include <vector>
+
+namespace onnc {
+namespace foonvdla {
+
+enum class NvDlaIRFormat : unsigned
+{
+  kText = 0, // one line per operator, as ComputeOperator::print
+  kDot,      // Graphviz
+  kBinary    // NvDlaIRSnapshot, compact and readable back for diffing
+};
+
+/** \struct NvDlaIRPrintOptions
+ *  \brief Which graphs PrintONNCIRPass prints and where.
+ *
+ *  A graph is printed right before or after a pass of the listed names, "*"
+ *  matches every pass. Nothing is printed, nor even formatted, by default.
+ */
+struct NvDlaIRPrintOptions
+{
+  std::vector<std::string> printBefore;
+  std::vector<std::string> printAfter;
+  std::vector<std::string> opKinds;   // operators printed, empty for all
+  std::string              directory; // one file per graph, empty for stdout
+  NvDlaIRFormat            format = NvDlaIRFormat::kText;
+
+  bool isPrintedBefore(const std::string& passName) const;
+
+  bool isPrintedAfter(const std::string& passName) const;
+
+  bool isPrinted(const ComputeOperator& op) const;
+
+  /// The items of a comma separated list.
+  static std::vector<std::string> split(const std::string& list);
+};
+
+/** \class NvDlaIRSnapshot
+ *  \brief Operators of a ComputeGraph with their kinds, attributes, inputs and
+ *  output shapes, saved in a compact binary form.
+ *
+ *  The file is "NVIR", a version, a table of the distinct strings and then the
+ *  values and operators in graph order, all numbers as LEB128 varints. Two
+ *  snapshots of one model are compared by diff(), which keys operators by
+ *  their kind and output names, so unrelated reordering is not reported.
+ */
+class NvDlaIRSnapshot
+{
+public:
+  static const std::uint32_t VERSION = 1;
+
+  struct ValueInfo
+  {
+    std::string               name;
+    std::vector<std::int64_t> dims;
+  };
+
+  struct OperatorInfo
+  {
+    std::string           kind;
+    std::string           attributes;
+    std::vector<unsigned> inputs; // indices of getValues()
+    std::vector<unsigned> outputs;
+  };
+
+public:
+  /// Take the operators of @ref pCG which @ref options prints.
+  static NvDlaIRSnapshot take(ComputeGraph& pCG, const NvDlaIRPrintOptions& options);
+
+  const std::vector<ValueInfo>& getValues() const noexcept { return m_Values; }
+
+  const std::vector<OperatorInfo>& getOperators() const noexcept { return m_Operators; }
+
+  void write(std::ostream& os) const;
+
+  /// Read a snapshot written by write(), false if @ref is is not one. Every
+  /// size is checked against the rest of the stream, which must be seekable,
+  /// such as a file or a string stream.
+  static bool read(std::istream& is, NvDlaIRSnapshot& snapshot);
+
+  /// Print the operators removed, added and changed from @ref from to @ref to,
+  /// and return how many there are.
+  static unsigned diff(const NvDlaIRSnapshot& from, const NvDlaIRSnapshot& to, std::ostream& os);
+
+private:
+  std::vector<ValueInfo>    m_Values;
+  std::vector<OperatorInfo> m_Operators;
+};
+
+} // namespace foonvdla
+} // namespace onnc
+
+#endif
@@ -0,0 +1,145 @@
+//===- NvDlaLiveness.cpp --------------------------------------------------===//
+//
+//                             The ONNC Project
+//
+// See LICENSE.TXT for details.
+//
+//===----------------------------------------------------------------------===//
+#include "NvDlaLiveness.h"
+
+#include "NvDlaUtil.h"
+
+#include <onnc/IR/Compute/InputOperator.h>
+#include <onnc/IR/Compute/OutputOperator.h>
+#include <onnc/Support/Casting.h>
+
+#include <algorithm>
+#include <cassert>
+#include <unordered_map>
+
+namespace onnc {
+namespace foonvdla {
+
+//===----------------------------------------------------------------------===//
+// NvDlaLiveness
+//===----------------------------------------------------------------------===//
+NvDlaLiveness::NvDlaLiveness(const NvDlaConstants& constants, const OperatorList& order)
+  : NvDlaConstants{constants}
+  , m_LiveBytes(order.size(), 0)
+{
+  if (order.empty()) {
+    return;
+  }
+
+  // an operator appears more than once if it is recomputed
+  std::unordered_map<const ComputeOperator*, std::vector<std::size_t>> steps;
+  for (std::size_t step = 0; step < order.size(); ++step) {
+    steps[order[step]].emplace_back(step);
+  }
+
+  const std::size_t lastStep = order.size() - 1;
+  for (std::size_t step = 0; step < order.size(); ++step) {
+    ComputeOperator* op = order[step];
+
+    // uses after the next definition belong to the recomputed value
+    const std::vector<std::size_t>& defSteps = steps[op];
+    const auto        nextDef  = std::upper_bound(defSteps.begin(), defSteps.end(), step);
+    const std::size_t limit    = (nextDef == defSteps.end() ? order.size() : *nextDef);
+    for (unsigned idx = 0; idx < op->getNumOfOutputs(); ++idx) {
+      const Tensor* tensor = dynamic_cast<const Tensor*>(op->getOutput(idx));
+      if (tensor == nullptr || !isActivation(*tensor)) {
+        continue;
+      }
+
+      Interval interval{tensor, isa<InputOperator>(op) ? 0 : step, step, getTensorSize(*tensor)};
+      for (const auto& use : tensor->getUses()) {
+        const ComputeOperator* user = use.getUser();
+        if (isa<OutputOperator>(user)) {
+          if (limit == order.size()) {
+            interval.end = lastStep;
+          }
+          continue;
+        }
+
+        const auto found = steps.find(user);
+        if (found == steps.end()) {
+          continue;
+        }
+        for (std::size_t useStep : found->second) {
+          if (step <= useStep && useStep < limit) {
+            interval.end = std::max(interval.end, useStep);
+          }
+        }
+      }
+
+      m_Intervals.emplace_back(interval);
+    }
+  }
+
+  // accumulate live bytes by a difference array over the steps
+  std::vector<Size> delta(order.size() + 1, 0);
+  for (const Interval& interval : m_Intervals) {
+    delta[interval.start] += interval.size;
+    delta[interval.end + 1] -= interval.size;
+  }
+
+  Size live = 0;
+  for (std::size_t step = 0; step < order.size(); ++step) {
+    live += delta[step];
+    m_LiveBytes[step] = live;
+  }
+}
+
+NvDlaLiveness::Size NvDlaLiveness::getPeakBytes() const
+{
+  if (m_LiveBytes.empty()) {
+    return 0;
+  }
+
+  return *std::max_element(m_LiveBytes.begin(), m_LiveBytes.end());
+}
+
+std::size_t NvDlaLiveness::getPeakStep() const
+{
+  return std::distance(m_LiveBytes.begin(), std::max_element(m_LiveBytes.begin(), m_LiveBytes.end()));
+}
+
+NvDlaLiveness::Size NvDlaLiveness::getTensorSize(const Tensor& tensor) const
+{
+  return getTensorSize(*this, tensor);
+}
+
+NvDlaLiveness::Size NvDlaLiveness::getTensorSize(const NvDlaConstants& constants, const Tensor& tensor)
+{
+  int dims[4] = {1, 1, 1, 1};
+  int idx     = 0;
+
+  // fold leading dimensions of high rank tensors into the batch dimension
+  const Tensor::Dimensions& dimensions = tensor.getDimensions();
+  const std::size_t         numFolded  = (dimensions.size() > 4 ? dimensions.size() - 3 : 1);
+  for (std::size_t i = 0; i < dimensions.size(); ++i) {
+    if (0 < i && i < numFolded) {
+      dims[0] *= dimensions[i];
+      continue;
+    }
+    dims[idx++] = dimensions[i];
+  }
+
+  // a feature cube holds one batch, the batches are laid out one after another
+  const NvDlaCubeInfo cubeinfo(constants, NVDLA_CUBE_FEATURE, dims[0], dims[1], dims[2], dims[3]);
+  return static_cast<Size>(dims[0]) * cubeinfo.size;
+}
+
+bool NvDlaLiveness::isActivation(const Tensor& tensor) { return !isConstant(tensor); }
+
+NvDlaLiveness::OperatorList NvDlaLiveness::getOperatorList(ComputeGraph& pCG)
+{
+  OperatorList order;
+  for (ComputeOperator& op : pCG) {
+    order.emplace_back(&op);
+  }
+  return order;
+}
+
+} // namespace foonvdla
+} // namespace onnc
@@ -0,0 +1,75 @@
+//===- NvDlaLiveness.h ----------------------------------------------------===//
+//
+//                             The ONNC Project
+//
+// See LICENSE.TXT for details.
+//
+//===----------------------------------------------------------------------===//
+#ifndef TARGET_FOONVDLA_NVDLA_LIVENESS_H
+#define TARGET_FOONVDLA_NVDLA_LIVENESS_H
+
+#include "NvDlaDefine.h"
+#include "NvDlaMeta.h"
+
+#include <onnc/IR/ComputeGraph.h>
+#include <onnc/IR/ComputeOperator.h>
+
+#include <cstddef>
+#include <vector>
+
+namespace onnc {
+namespace foonvdla {
+
+/** \class NvDlaLiveness
+ *  \brief Live ranges of activation tensors over a given operator order.
+ *
+ *  A tensor is live from the operator that defines it to its last consumer.
+ *  Graph inputs are live from the beginning and graph outputs stay live until
+ *  the end. Constant tensors are packed into their own blobs and are ignored.
+ *  Sizes are NVDLA feature cube sizes, i.e. what NvDlaMemInfoPass allocates.
+ *  An operator may appear more than once in the order if it is recomputed,
+ *  then each definition of its outputs gets an interval of its own.
+ */
+class NvDlaLiveness : private NvDlaConstants
+{
+public:
+  using Size         = NvDlaBackendMeta::MemoryListEntrySize;
+  using OperatorList = std::vector<ComputeOperator*>;
+
+  struct Interval
+  {
+    const Tensor* tensor;
+    std::size_t   start;
+    std::size_t   end; // inclusive
+    Size          size;
+  };
+
+public:
+  NvDlaLiveness(const NvDlaConstants& constants, const OperatorList& order);
+
+  const std::vector<Interval>& getIntervals() const noexcept { return m_Intervals; }
+
+  /// Sum of live tensor bytes at each step of the order.
+  const std::vector<Size>& getLiveBytes() const noexcept { return m_LiveBytes; }
+
+  Size getPeakBytes() const;
+
+  std::size_t getPeakStep() const;
+
+  Size getTensorSize(const Tensor& tensor) const;
+
+  static Size getTensorSize(const NvDlaConstants& constants, const Tensor& tensor);
+
+  static bool isActivation(const Tensor& tensor);
+
+  static OperatorList getOperatorList(ComputeGraph& pCG);
+
+private:
+  std::vector<Interval> m_Intervals;
+  std::vector<Size>     m_LiveBytes;
+};
+
+} // namespace foonvdla
+} // namespace onnc
+
+#endif
@@ -0,0 +1,302 @@
+//===- NvDlaLowerGroupConvPass.cpp ----------------------------------------===//
+//
+//                             The ONNC Project
+//
+// See LICENSE.TXT for details.
+//
+//===----------------------------------------------------------------------===//
+#include "NvDlaLowerGroupConvPass.h"
+
+#include "NvDlaBroadcast.h"
+#include "NvDlaMeta.h"
+#include "NvDlaUtil.h"
+
+#include <onnc/Core/PassSupport.h>
+#include <onnc/IR/Compute/Add.h>
+#include <onnc/IR/Compute/Initializer.h>
+#include <onnc/IR/Compute/Mul.h>
+#include <onnc/IR/ComputeOperator.h>
+
+#include <algorithm>
+#include <cassert>
+#include <cmath>
+#include <iostream>
+#include <string>
+#include <vector>
+
+namespace onnc {
+namespace foonvdla {
+
+namespace internal {
+
+// cycles for the firmware to program and launch one CONV hardware layer
+const NvDlaPerfModel::Cycles kConvLaunchCycles = 500;
+
+/// The weight [K, C / group, kh, kw] of a grouped Conv, if it is a constant
+/// float tensor with all its values, or nullptr.
+const FloatTensor* getGroupedWeight(const Conv& conv)
+{
+  const std::int64_t group = conv.getGroup().value();
+  if (group <= 1 || conv.getNumOfInputs() < 2 || conv.getInput(0)->getNumOfDimensions() != 4 ||
+      conv.getOutput(0)->getNumOfDimensions() != 4) {
+    return nullptr;
+  }
+
+  const FloatTensor* weight = dynamic_cast<const FloatTensor*>(conv.getInput(1));
+  if (weight == nullptr || !isConstant(*weight) || weight->getNumOfDimensions() != 4 ||
+      weight->getValues().size() != NvDlaBroadcast::getNumOfElements(weight->getDimensions())) {
+    return nullptr;
+  }
+
+  if (weight->dimension(0) % group != 0 || weight->dimension(1) * group != conv.getInput(0)->dimension(1)) {
+    return nullptr;
+  }
+  return weight;
+}
+
+/// A depthwise 1x1 Conv with stride 1 multiplies every channel by a constant.
+bool isPointwiseDepthwise(const ComputeOperator& op)
+{
+  const Conv&        conv   = *dyn_cast<Conv>(&op);
+  const FloatTensor* weight = getGroupedWeight(conv);
+  if (weight == nullptr) {
+    return false;
+  }
+
+  const Tensor::Dimension numChannels = conv.getInput(0)->dimension(1);
+  if (conv.getGroup().value() != numChannels || weight->dimension(0) != numChannels || weight->dimension(2) != 1 ||
+      weight->dimension(3) != 1) {
+    return false;
+  }
+
+  // no stride and no padding, so the output keeps the input shape
+  for (std::int64_t stride : conv.getStrides().vector()) {
+    if (stride != 1) {
+      return false;
+    }
+  }
+  if (conv.getOutput(0)->getDimensions() != conv.getInput(0)->getDimensions()) {
+    return false;
+  }
+
+  if (conv.getNumOfInputs() < 3) {
+    return true;
+  }
+  const FloatTensor* bias = dynamic_cast<const FloatTensor*>(conv.getInput(2));
+  return bias != nullptr && isConstant(*bias) &&
+         bias->getValues().size() == static_cast<std::size_t>(numChannels);
+}
+
+} // namespace internal
+
+//===----------------------------------------------------------------------===//
+// NvDlaLowerGroupConvPass
+//===----------------------------------------------------------------------===//
+unsigned NvDlaLowerGroupConvPass::tensorIdx = 0;
+
+NvDlaLowerGroupConvPass::NvDlaLowerGroupConvPass(const NvDlaConstants& constants,
+                                                 const NvDlaPerfModel& perfModel) noexcept
+  : NvDlaConstants{constants}
+  , m_PerfModel{perfModel}
+  , m_NumOfPacked{0}
+{}
+
+Pass::ReturnType NvDlaLowerGroupConvPass::runOnComputeGraph(ComputeGraph& pCG)
+{
+  Pass::ReturnType ret = Pass::kModuleNoChanged;
+
+  // Only a Conv which is cheapest as one dense conv is repacked, since the
+  // emitter has no path for a Conv left with group > 1. The result has no
+  // group, so it is not matched again.
+  const auto shouldRepack = [this](const ComputeOperator& op) {
+    const Conv& conv = *dyn_cast<Conv>(&op);
+    return internal::getGroupedWeight(conv) != nullptr && !internal::isPointwiseDepthwise(op) &&
+           getCheapest(conv).numMerged == conv.getGroup().value();
+  };
+
+  m_NumOfPacked = 0;
+
+  NvDlaRewriteDriver driver(pCG);
+  driver
+    .add(NvDlaPattern("PointwiseDepthwise").op<Conv>().where(internal::isPointwiseDepthwise),
+         [this](const NvDlaPatternMatch& match, NvDlaRewriteDriver& rewriter) { lowerDepthwise(match, rewriter); })
+    .add(NvDlaPattern("GroupConv").op<Conv>().where(shouldRepack),
+         [this](const NvDlaPatternMatch& match, NvDlaRewriteDriver& rewriter) { repack(match, rewriter); });
+
+  const unsigned numOfLowered = driver.run();
+  if (numOfLowered != 0) {
+    std::cout << "NvDlaLowerGroupConvPass: repacked " << m_NumOfPacked << " grouped Conv, lowered "
+              << numOfLowered - m_NumOfPacked << " depthwise Conv to SDP\n";
+    ret |= Pass::kModuleChanged;
+  }
+
+  return ret;
+}
+
+NvDlaLowerGroupConvPass::Cost NvDlaLowerGroupConvPass::estimate(const Conv& conv, Tensor::Dimension numMerged) const
+{
+  const Tensor::Dimensions& weightDims = conv.getInput(1)->getDimensions();
+  const Tensor::Dimensions& outputDims = conv.getOutput(0)->getDimensions();
+
+  // every conv reads numChannels channels at an offset and writes numKernels channels
+  const Bytes numConvs    = conv.getGroup().value() / numMerged;
+  const Bytes numKernels  = weightDims[0] / numConvs;
+  const Bytes numChannels = weightDims[1] * numMerged;
+  const Bytes kernelSize  = weightDims[2] * weightDims[3];
+  const Bytes numPixels   = outputDims[0] * outputDims[2] * outputDims[3];
+
+  Cost cost;
+  cost.numMerged = numMerged;
+  cost.macs      = numConvs * numPixels * kernelSize * numChannels * numKernels;
+
+  const NvDlaCubeInfo weightCube(*this, NVDLA_CUBE_WEIGHT, numKernels, numChannels, weightDims[2], weightDims[3]);
+  cost.weightBytes = numConvs * weightCube.size;
+
+  // an atomic operation takes one cycle, however few of its channels and
+  // kernels are used. The input and output traffic is the same for any packing.
+  const Cycles computeCycles = numConvs * numPixels * kernelSize *
+                               DIV_ROUNDUP(numChannels, static_cast<Bytes>(MAC_ATOMIC_C)) *
+                               DIV_ROUNDUP(numKernels, static_cast<Bytes>(MAC_ATOMIC_K));
+  const Cycles memoryCycles =
+    static_cast<Cycles>(std::ceil(cost.weightBytes / m_PerfModel.getDramBytesPerCycle()));
+  cost.cycles = std::max(computeCycles, memoryCycles) + numConvs * internal::kConvLaunchCycles;
+  return cost;
+}
+
+NvDlaLowerGroupConvPass::Cost NvDlaLowerGroupConvPass::getCheapest(const Conv& conv) const
+{
+  const Tensor::Dimension group = conv.getGroup().value();
+
+  Cost cheapest = estimate(conv, 1);
+  for (Tensor::Dimension numMerged = 2; numMerged <= group; ++numMerged) {
+    if (group % numMerged != 0) {
+      continue;
+    }
+    const Cost cost = estimate(conv, numMerged);
+    if (cost.cycles < cheapest.cycles) {
+      cheapest = cost;
+    }
+  }
+  return cheapest;
+}
+
+void NvDlaLowerGroupConvPass::repack(const NvDlaPatternMatch& match, NvDlaRewriteDriver& driver)
+{
+  Conv*        conv   = dyn_cast<Conv>(match.operators[0]);
+  FloatTensor* weight = dynamic_cast<FloatTensor*>(conv->getInput(1));
+
+  const Cost split    = estimate(*conv, 1);
+  const Cost cheapest = getCheapest(*conv);
+
+  const Tensor::Dimension group           = conv->getGroup().value();
+  const Tensor::Dimension numMerged       = cheapest.numMerged;
+  const Tensor::Dimension numKernels      = weight->dimension(0);
+  const Tensor::Dimension numChannels     = weight->dimension(1);
+  const Tensor::Dimension kernelsPerGroup = numKernels / group;
+  const Tensor::Dimension kernelSize      = weight->dimension(2) * weight->dimension(3);
+
+  std::cout << "NvDlaLowerGroupConvPass: " << conv->getOutput(0)->getName() << " group " << group << " -> "
+            << group / numMerged << ", MACs " << split.macs << " -> " << cheapest.macs << ", weight bytes "
+            << split.weightBytes << " -> " << cheapest.weightBytes << ", cycles " << split.cycles << " -> "
+            << cheapest.cycles << "\n";
+
+  // Kernel k of group g reads the channels of g at (g % numMerged) * numChannels
+  // in its merged group, the other channels are zero.
+  FloatTensor* packed = dynamic_cast<FloatTensor*>(weight->create());
+  packed->setName(weight->getName() + "__group_" + std::to_string(tensorIdx++));
+  packed->setDimensions({numKernels, numChannels * numMerged, weight->dimension(2), weight->dimension(3)});
+  packed->getValues().assign(numKernels * numChannels * numMerged * kernelSize, 0.0f);
+
+  const std::vector<float>& values = weight->getValues();
+  for (Tensor::Dimension kernel = 0; kernel < numKernels; ++kernel) {
+    const Tensor::Dimension channelOffset = (kernel / kernelsPerGroup) % numMerged * numChannels;
+    std::copy_n(values.begin() + kernel * numChannels * kernelSize, numChannels * kernelSize,
+                packed->getValues().begin() + (kernel * numChannels * numMerged + channelOffset) * kernelSize);
+  }
+
+  packed = driver.getGraph().addValue<FloatTensor>(packed);
+  assert((packed != nullptr) && "The name must be unique");
+  driver.addOperator<Initializer>()->setTensor(*packed);
+
+  Tensor* input  = conv->getInput(0);
+  Tensor* bias   = (conv->getNumOfInputs() < 3 ? nullptr : conv->getInput(2));
+  Tensor* output = conv->getOutput(0);
+  conv->removeAllInputs();
+  conv->removeAllOutputs();
+  driver.collect(*weight);
+
+  conv->addInput(*input);
+  conv->addInput(*packed);
+  if (bias != nullptr) {
+    conv->addInput(*bias);
+  }
+  conv->addOutput(*output);
+  conv->setGroup(IntAttr(group / numMerged));
+
+  ++m_NumOfPacked;
+}
+
+void NvDlaLowerGroupConvPass::lowerDepthwise(const NvDlaPatternMatch& match, NvDlaRewriteDriver& driver)
+{
+  Conv*        conv    = dyn_cast<Conv>(match.operators[0]);
+  Tensor*      inputX  = conv->getInput(0);
+  FloatTensor* weight  = dynamic_cast<FloatTensor*>(conv->getInput(1));
+  FloatTensor* bias    = (conv->getNumOfInputs() < 3 ? nullptr : dynamic_cast<FloatTensor*>(conv->getInput(2)));
+  Tensor*      outputY = conv->getOutput(0);
+
+  conv->removeAllInputs();
+  conv->removeAllOutputs();
+  driver.erase(*conv);
+
+  // Create a [1, C, 1, 1] copy of @ref source with its Initializer, it
+  // broadcasts over the spatial axes.
+  const std::string suffix = "__dw_" + std::to_string(tensorIdx++);
+  auto addChannelConstant = [&driver, &suffix, weight](FloatTensor& source) {
+    FloatTensor* constant = dynamic_cast<FloatTensor*>(source.create());
+    constant->setName(source.getName() + suffix);
+    constant->setDimensions({1, weight->dimension(0), 1, 1});
+    constant = driver.getGraph().addValue<FloatTensor>(constant);
+    assert((constant != nullptr) && "The name must be unique");
+    constant->getValues() = source.getValues();
+
+    driver.addOperator<Initializer>()->setTensor(*constant);
+    driver.collect(source);
+    return constant;
+  };
+
+  // The current ONNC IR graph status
+  // ================================
+  //
+  //    |        |          |
+  // inputX  scale[C]  (shift[C])
+  //      \      |       /
+  //         (conv 1x1)
+  //             |
+  //          outputY
+  //             |
+  //
+  // becomes outputY = inputX * scale + shift, which
+  // NvDlaReorderMulAddPass and NvDlaFuseAddMulReluPass put in one SDP operation.
+  Mul* mul = driver.addOperator<Mul>();
+  mul->addInput(*inputX);
+  mul->addInput(*addChannelConstant(*weight));
+  if (bias == nullptr) {
+    mul->addOutput(*outputY);
+    return;
+  }
+
+  Tensor* tmp = dynamic_cast<Tensor*>(outputY->create());
+  tmp->setName(outputY->getName() + suffix);
+  tmp->setDimensions(outputY->getDimensions());
+  tmp = driver.getGraph().addValue<Tensor>(tmp);
+  assert((tmp != nullptr) && "The name must be unique");
+  mul->addOutput(*tmp);
+
+  Add* add = driver.addOperator<Add>();
+  add->addInput(*tmp);
+  add->addInput(*addChannelConstant(*bias));
+  add->addOutput(*outputY);
+}
+
+} // namespace foonvdla
+} // namespace onnc
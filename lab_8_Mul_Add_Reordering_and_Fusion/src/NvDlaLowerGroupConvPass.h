@@ -0,0 +1,81 @@
+//===- NvDlaLowerGroupConvPass.h ------------------------------------------===//
+//
+//                             The ONNC Project
+//
+// See LICENSE.TXT for details.
+//
+//===----------------------------------------------------------------------===//
+#ifndef ONNC_FOONVDLA_LOWER_GROUP_CONV_PASS_H
+#define ONNC_FOONVDLA_LOWER_GROUP_CONV_PASS_H
+#include "NvDlaDefine.h"
+#include "NvDlaPattern.h"
+#include "NvDlaPerfModel.h"
+#include "NvDlaRewriteDriver.h"
+
+#include <onnc/Core/CustomPass.h>
+#include <onnc/IR/Compute/Conv.h>
+
+namespace onnc {
+namespace foonvdla {
+
+/** \class NvDlaLowerGroupConvPass
+ *  \brief Choose how each grouped Conv runs on the CONV engine.
+ *
+ *  CONV computes MAC_ATOMIC_C input channels by MAC_ATOMIC_K kernels per
+ *  cycle, so a small group wastes most of an atomic operation. Merging m
+ *  adjacent groups into one with block-diagonal weights fills the atoms, but
+ *  the zeros are also fetched and multiplied. Every divisor m of the group
+ *  count is estimated, from m = 1 (one conv per group, all reading the same
+ *  input surface at a channel offset) to m = group (one dense conv). The
+ *  weights are repacked only when the dense conv is the cheapest: any other
+ *  packing leaves a Conv with group > 1, which has to be emitted as one CONV
+ *  per group, each packed by packWeight() at its outputChannelOffset. That
+ *  is part of the Conv emitter, which this lab leaves to the reader, so such
+ *  a Conv is kept as it is.
+ *
+ *  A 1x1 depthwise Conv with stride 1 scales every channel by a constant, so
+ *  it becomes a per-channel Mul (and Add of the bias) for SDP instead. A k x k
+ *  depthwise Conv has no such path, it is estimated and repacked like any
+ *  other grouped Conv.
+ */
+class NvDlaLowerGroupConvPass : public CustomPass<NvDlaLowerGroupConvPass>, private NvDlaConstants
+{
+public:
+  using Cycles = NvDlaPerfModel::Cycles;
+  using Bytes  = NvDlaPerfModel::Bytes;
+
+  struct Cost
+  {
+    Tensor::Dimension numMerged   = 1; // # of groups packed into one conv
+    Bytes             macs        = 0; // including the block-diagonal zeros
+    Bytes             weightBytes = 0;
+    Cycles            cycles      = 0;
+  };
+
+public:
+  NvDlaLowerGroupConvPass(const NvDlaConstants& constants, const NvDlaPerfModel& perfModel) noexcept;
+
+  ReturnType runOnComputeGraph(ComputeGraph& pCG) override;
+
+private:
+  /// Estimate @ref conv with every @ref numMerged groups packed into one conv.
+  Cost estimate(const Conv& conv, Tensor::Dimension numMerged) const;
+
+  /// The cheapest packing, the fewest merged groups on a tie.
+  Cost getCheapest(const Conv& conv) const;
+
+  void repack(const NvDlaPatternMatch& match, NvDlaRewriteDriver& driver);
+
+  void lowerDepthwise(const NvDlaPatternMatch& match, NvDlaRewriteDriver& driver);
+
+private:
+  NvDlaPerfModel m_PerfModel;
+  unsigned       m_NumOfPacked;
+
+  static unsigned tensorIdx;
+};
+
+} // namespace foonvdla
+} // namespace onnc
+
+#endif
@@ -0,0 +1,208 @@
+//===- NvDlaMemAllocator.cpp ----------------------------------------------===//
+//
+//                             The ONNC Project
+//
+// See LICENSE.TXT for details.
+//
+//===----------------------------------------------------------------------===//
+#include "NvDlaMemAllocator.h"
+
+#include <algorithm>
+#include <cassert>
+#include <limits>
+#include <unordered_map>
+
+namespace onnc {
+namespace foonvdla {
+
+namespace internal {
+
+using Interval = NvDlaLiveness::Interval;
+
+/// All live intervals of one tensor, they share one block in the arena.
+struct Block
+{
+  const Tensor*         tensor;
+  NvDlaLiveness::Size   size;
+  std::size_t           start;
+  std::vector<Interval> intervals;
+};
+
+bool isOverlapped(const Interval& lhs, const Interval& rhs)
+{
+  return lhs.start <= rhs.end && rhs.start <= lhs.end;
+}
+
+bool isOverlapped(const Block& lhs, const Block& rhs)
+{
+  for (const Interval& left : lhs.intervals) {
+    for (const Interval& right : rhs.intervals) {
+      if (isOverlapped(left, right)) {
+        return true;
+      }
+    }
+  }
+  return false;
+}
+
+/// Group intervals by tensor, in the order of first appearance.
+std::vector<Block> getBlocks(const std::vector<Interval>& intervals)
+{
+  std::vector<Block>                             blocks;
+  std::unordered_map<const Tensor*, std::size_t> indices;
+  for (const Interval& interval : intervals) {
+    const auto found = indices.find(interval.tensor);
+    if (found == indices.end()) {
+      indices.emplace(interval.tensor, blocks.size());
+      blocks.push_back(Block{interval.tensor, interval.size, interval.start, {interval}});
+      continue;
+    }
+
+    Block& block = blocks[found->second];
+    block.size   = std::max(block.size, interval.size);
+    block.start  = std::min(block.start, interval.start);
+    block.intervals.push_back(interval);
+  }
+  return blocks;
+}
+
+} // namespace internal
+
+//===----------------------------------------------------------------------===//
+// NvDlaMemAllocator
+//===----------------------------------------------------------------------===//
+NvDlaMemAllocator::NvDlaMemAllocator(Size alignment, Size entryAlignment) noexcept
+  : m_Alignment{alignment}
+  , m_EntryAlignment{entryAlignment}
+{}
+
+NvDlaMemAllocator::Result NvDlaMemAllocator::allocate(NvDlaMemAllocStrategy strategy,
+                                                      const std::vector<Interval>& intervals) const
+{
+  switch (strategy) {
+  case NvDlaMemAllocStrategy::kSeparate:
+    return allocateSeparate(intervals);
+  case NvDlaMemAllocStrategy::kFirstFit:
+    return pack(intervals, false, GapPolicy::kLowest);
+  case NvDlaMemAllocStrategy::kBestFit:
+    return pack(intervals, false, GapPolicy::kSmallest);
+  case NvDlaMemAllocStrategy::kGreedyBySize:
+    return pack(intervals, true, GapPolicy::kSmallest);
+  case NvDlaMemAllocStrategy::kMinimumArena: {
+    Result bestFit      = allocate(NvDlaMemAllocStrategy::kBestFit, intervals);
+    Result greedyBySize = allocate(NvDlaMemAllocStrategy::kGreedyBySize, intervals);
+    return (greedyBySize.arenaSize < bestFit.arenaSize ? greedyBySize : bestFit);
+  }
+  default:
+    break;
+  }
+
+  assert(false && "meet unknown memory allocation strategy");
+  return Result{};
+}
+
+const char* NvDlaMemAllocator::getName(NvDlaMemAllocStrategy strategy)
+{
+  switch (strategy) {
+  case NvDlaMemAllocStrategy::kSeparate:
+    return "separate";
+  case NvDlaMemAllocStrategy::kFirstFit:
+    return "first-fit";
+  case NvDlaMemAllocStrategy::kBestFit:
+    return "best-fit";
+  case NvDlaMemAllocStrategy::kGreedyBySize:
+    return "greedy-by-size";
+  case NvDlaMemAllocStrategy::kMinimumArena:
+    return "minimum-arena";
+  default:
+    break;
+  }
+  return "unknown";
+}
+
+double NvDlaMemAllocator::getFragmentation(const Result& result, Size peakBytes)
+{
+  if (result.arenaSize == 0) {
+    return 0.0;
+  }
+
+  return 1.0 - static_cast<double>(peakBytes) / static_cast<double>(result.arenaSize);
+}
+
+NvDlaMemAllocator::Result NvDlaMemAllocator::allocateSeparate(const std::vector<Interval>& intervals) const
+{
+  // What NvDlaMemInfoPass does without an arena: every tensor owns a
+  // MemoryListEntry, and every entry is aligned to the page size.
+  Result result{{}, 0};
+  for (const internal::Block& block : internal::getBlocks(intervals)) {
+    const Size size = UNIT_ALIGNMENT(block.size, m_Alignment);
+    result.placements.push_back(Placement{block.tensor, result.arenaSize, size});
+    result.arenaSize += UNIT_ALIGNMENT(size, m_EntryAlignment);
+  }
+  return result;
+}
+
+NvDlaMemAllocator::Result NvDlaMemAllocator::pack(const std::vector<Interval>& intervals, bool bySize,
+                                                  GapPolicy policy) const
+{
+  using internal::Block;
+  using internal::isOverlapped;
+
+  std::vector<Block> blocks = internal::getBlocks(intervals);
+
+  // ties are broken by the live range start, so the result is deterministic
+  std::stable_sort(blocks.begin(), blocks.end(), [bySize](const Block& lhs, const Block& rhs) {
+    if (bySize && lhs.size != rhs.size) {
+      return lhs.size > rhs.size;
+    }
+    return lhs.start < rhs.start;
+  });
+
+  Result                 result{{}, 0};
+  std::vector<Block>     placed;
+  std::vector<Placement> conflicts;
+  for (const Block& block : blocks) {
+    const Size size = UNIT_ALIGNMENT(block.size, m_Alignment);
+
+    // blocks which are live at the same time, sorted by offset
+    conflicts.clear();
+    for (std::size_t idx = 0; idx < placed.size(); ++idx) {
+      if (isOverlapped(placed[idx], block)) {
+        conflicts.push_back(result.placements[idx]);
+      }
+    }
+    std::sort(conflicts.begin(), conflicts.end(),
+              [](const Placement& lhs, const Placement& rhs) { return lhs.offset < rhs.offset; });
+
+    // walk through the free gaps between the conflicting blocks
+    Size offset  = std::numeric_limits<Size>::max();
+    Size bestGap = std::numeric_limits<Size>::max();
+    Size top     = 0;
+    for (const Placement& conflict : conflicts) {
+      if (top < conflict.offset) {
+        const Size gap      = conflict.offset - top;
+        const bool isBetter = (policy == GapPolicy::kSmallest) ? (gap < bestGap)
+                                                               : (offset == std::numeric_limits<Size>::max());
+        if (size <= gap && isBetter) {
+          offset  = top;
+          bestGap = gap;
+        }
+      }
+      top = std::max(top, UNIT_ALIGNMENT(conflict.offset + conflict.size, m_Alignment));
+    }
+
+    // no gap fits, put it on the top of the conflicting blocks
+    if (offset == std::numeric_limits<Size>::max()) {
+      offset = top;
+    }
+
+    placed.push_back(block);
+    result.placements.push_back(Placement{block.tensor, offset, size});
+    result.arenaSize = std::max(result.arenaSize, offset + size);
+  }
+
+  return result;
+}
+
+} // namespace foonvdla
+} // namespace onnc
@@ -0,0 +1,84 @@
+//===- NvDlaMemAllocator.h ------------------------------------------------===//
+//
+//                             The ONNC Project
+//
+// See LICENSE.TXT for details.
+//
+//===----------------------------------------------------------------------===//
+#ifndef TARGET_FOONVDLA_NVDLA_MEM_ALLOCATOR_H
+#define TARGET_FOONVDLA_NVDLA_MEM_ALLOCATOR_H
+
+#include "NvDlaLiveness.h"
+
+#include <vector>
+
+namespace onnc {
+namespace foonvdla {
+
+enum class NvDlaMemAllocStrategy : unsigned
+{
+  kSeparate = 0,  // one MemoryListEntry per tensor (no reuse)
+  kFirstFit,      // linear scan by start, lowest free offset
+  kBestFit,       // linear scan by start, smallest free gap
+  kGreedyBySize,  // largest tensors first, smallest free gap
+  kMinimumArena   // the smaller arena of kBestFit and kGreedyBySize
+};
+
+/** \class NvDlaMemAllocator
+ *  \brief Assign offsets in a shared arena to activation tensors.
+ *
+ *  Offset assignment is solved as interval packing: two tensors may share
+ *  bytes only if their live intervals do not overlap. Offsets and sizes are
+ *  rounded up to the given alignment (the feature ATOM size on NVDLA). A
+ *  tensor may come with several intervals (e.g. it is recomputed), they all
+ *  get the same offset.
+ */
+class NvDlaMemAllocator
+{
+public:
+  using Size     = NvDlaLiveness::Size;
+  using Interval = NvDlaLiveness::Interval;
+
+  struct Placement
+  {
+    const Tensor* tensor;
+    Size          offset;
+    Size          size;
+  };
+
+  struct Result
+  {
+    std::vector<Placement> placements;
+    Size                   arenaSize;
+  };
+
+public:
+  NvDlaMemAllocator(Size alignment, Size entryAlignment) noexcept;
+
+  Result allocate(NvDlaMemAllocStrategy strategy, const std::vector<Interval>& intervals) const;
+
+  static const char* getName(NvDlaMemAllocStrategy strategy);
+
+  /// 1 - (peak live bytes / arena size), 0 means no byte is wasted at the peak.
+  static double getFragmentation(const Result& result, Size peakBytes);
+
+private:
+  enum class GapPolicy
+  {
+    kLowest,
+    kSmallest
+  };
+
+  Result allocateSeparate(const std::vector<Interval>& intervals) const;
+
+  Result pack(const std::vector<Interval>& intervals, bool bySize, GapPolicy policy) const;
+
+private:
+  Size m_Alignment;
+  Size m_EntryAlignment;
+};
+
+} // namespace foonvdla
+} // namespace onnc
+
+#endif
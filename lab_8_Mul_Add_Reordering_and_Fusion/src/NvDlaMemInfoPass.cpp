@@ -0,0 +1,557 @@
+//===- NvDlaMemInfoPass.cpp -----------------------------------------------===//
+//
+//                             The ONNC Project
+//
+// See LICENSE.TXT for details.
+//
+//===----------------------------------------------------------------------===//
+#include "NvDlaMemInfoPass.h"
+
+#include "NvDlaLiveness.h"
+#include "NvDlaTensorSchedPass.h"
+
+#include "NvDlaUtil.h"
+
+#include <onnc/IR/Compute/Initializer.h>
+#include <onnc/IR/Compute/InputOperator.h>
+#include <onnc/IR/Compute/OutputOperator.h>
+#include <onnc/IR/Compute/Reshape.h>
+#include <onnc/IR/Compute/Tensor.h>
+#include <onnc/Support/Casting.h>
+#include <onnc/Support/IOStream.h>
+
+#include <algorithm>
+#include <cassert>
+#include <iomanip>
+#include <iostream>
+#include <sstream>
+#include <unordered_map>
+#include <unordered_set>
+
+using namespace ::onnc::foonvdla::loadable;
+
+namespace onnc {
+namespace foonvdla {
+namespace internal {
+
+std::vector<NvDlaLiveness::Size> getLiveBytes(const std::vector<NvDlaLiveness::Interval>& intervals,
+                                              std::size_t                                 numSteps)
+{
+  std::vector<NvDlaLiveness::Size> delta(numSteps + 1, 0);
+  for (const NvDlaLiveness::Interval& interval : intervals) {
+    delta[interval.start] += interval.size;
+    delta[interval.end + 1] -= interval.size;
+  }
+
+  NvDlaLiveness::Size live = 0;
+  for (NvDlaLiveness::Size& bytes : delta) {
+    live += bytes;
+    bytes = live;
+  }
+  delta.pop_back();
+  return delta;
+}
+
+NvDlaLiveness::Size getPeakBytes(const std::vector<NvDlaLiveness::Interval>& intervals, std::size_t numSteps)
+{
+  const std::vector<NvDlaLiveness::Size> liveBytes = getLiveBytes(intervals, numSteps);
+  return (liveBytes.empty() ? 0 : *std::max_element(liveBytes.begin(), liveBytes.end()));
+}
+
+std::size_t getPeakStep(const std::vector<NvDlaLiveness::Interval>& intervals, std::size_t numSteps)
+{
+  const std::vector<NvDlaLiveness::Size> liveBytes = getLiveBytes(intervals, numSteps);
+  return std::distance(liveBytes.begin(), std::max_element(liveBytes.begin(), liveBytes.end()));
+}
+
+/// Whether the operator reads the tensor, or a reshaped view of it.
+bool isUsing(const ComputeOperator& op, const Tensor& tensor, const NvDlaBackendMeta& meta)
+{
+  for (unsigned idx = 0; idx < op.getNumOfInputs(); ++idx) {
+    const Tensor* input = static_cast<const Tensor*>(op.getInput(idx));
+    if (input == &tensor || (meta.isReshaped(*input) && &meta.getReshapeSource(*input) == &tensor)) {
+      return true;
+    }
+  }
+  return false;
+}
+
+} // namespace internal
+} // namespace foonvdla
+} // namespace onnc
+
+//===----------------------------------------------------------------------===//
+// NvDlaMemInfoPass
+//===----------------------------------------------------------------------===//
+namespace onnc {
+namespace foonvdla {
+NvDlaMemInfoPass::NvDlaMemInfoPass(const NvDlaConstants& constants, NvDlaBackendMeta* pMeta,
+                                   NvDlaMemAllocStrategy strategy, Size budget) noexcept
+  : NvDlaConstants{constants}
+  , m_pMeta{pMeta}
+  , m_Strategy{strategy}
+  , m_Budget{budget}
+{}
+
+Pass::ReturnType NvDlaMemInfoPass::runOnModule(Module& pModule)
+{
+  using namespace onnc::foonvdla;
+  // [0] entry of memory & address list
+  {
+    const MemoryListEntryId memoryId =
+      m_pMeta->allocateMemory(ILoadable::MemoryDomain_SYSMEM, ILoadable::MemoryFlags_ALLOC, 4096);
+    m_pMeta->acquireMemory(memoryId, 0, 4096);
+  }
+
+  using std::begin;
+  using std::end;
+
+  std::unordered_set<const Tensor*> outputTensors;
+  std::vector<const Tensor*>        tensors;
+  for (ComputeOperator& cm : *pModule.getRootComputeGraph()) {
+    // Reshape emits no operation, its output is a view of its input memory
+    if (Reshape* reshape = dyn_cast<Reshape>(&cm)) {
+      m_pMeta->markAsReshaped(*reshape->getInput(0), *reshape->getOutput(0));
+    }
+
+    if (OutputOperator* outputOperator = dyn_cast<OutputOperator>(&cm)) {
+      for (unsigned idx = 0; idx < outputOperator->getNumOfInputs(); ++idx) {
+        outputTensors.insert(static_cast<const Tensor*>(outputOperator->getInput(idx)));
+      }
+    }
+
+    for (unsigned idx = 0; idx < cm.getNumOfOutputs(); ++idx) {
+      const Tensor* output = static_cast<const Tensor*>(cm.getOutput(idx));
+      if (std::find(begin(tensors), end(tensors), output) == end(tensors)) {
+        tensors.emplace_back(output);
+      }
+    }
+  }
+  assert(!outputTensors.empty());
+
+  using std::end;
+  const auto isOutput = [&outputTensors](const Tensor* tensor) {
+    return outputTensors.find(tensor) != end(outputTensors);
+  };
+
+  // A graph output reshaped from an activation is bound to the memory of that
+  // activation, so it gets an entry of its own instead of a place in the arena.
+  std::unordered_set<const Tensor*> outputSources;
+  for (const Tensor* tensor : outputTensors) {
+    if (m_pMeta->isReshaped(*tensor)) {
+      outputSources.insert(&m_pMeta->getReshapeSource(*tensor));
+    }
+  }
+  
+  std::vector<const Tensor*> arenaTensors;
+  for (const Tensor* tensor : tensors) {
+    if (isConstant(*tensor)) {
+      continue;
+    }
+
+    // skip allocating memory for Reshape/Concat's input tensors
+    if (!(m_pMeta->shouldOwnMemory(*tensor) || isOutput(tensor))) {
+      continue;
+    }
+
+    // skip for already-allocated-memory tensors, a reshaped graph output still
+    // marks the memory of its source as output
+    if (m_pMeta->hasMemoryListEntry(*tensor) && !(isOutput(tensor) && m_pMeta->isReshaped(*tensor))) {
+      continue;
+    }
+
+    int dims[4] = {1, 1, 1, 1};
+    int idx     = 0;
+    for (auto i : tensor->getDimensions())
+      dims[idx++] = i;
+
+    const NvDlaCubeInfo cubeinfo(*this, NVDLA_CUBE_FEATURE, dims[0], dims[1], dims[2], dims[3], 0, 0);
+
+    const bool isInput = isa<InputOperator>(getProducer(*tensor));
+    if (isInput && !m_pMeta->hasMemoryListEntry(*tensor)) {
+      const MemoryListEntryId memoryId =
+        m_pMeta->allocateMemoryFor(*tensor, ILoadable::MemoryDomain_SYSMEM,
+                                   ILoadable::MemoryFlags_ALLOC | ILoadable::MemoryFlags_INPUT, cubeinfo.size);
+
+      ILoadable::TensorDescListEntry tle;
+      tle.name   = "data";
+      tle.id     = 0;
+      tle.memId  = memoryId;
+      tle.size   = m_pMeta->getMemoryListEntrySize(memoryId);
+      tle.offset = 0;
+
+      tle.dims.n       = cubeinfo.dim_n;
+      tle.dims.c       = cubeinfo.dim_c;
+      tle.dims.h       = cubeinfo.dim_h;
+      tle.dims.w       = cubeinfo.dim_w;
+      tle.dataFormat   = 3;
+      tle.dataType     = DATA_TYPE;
+      tle.dataCategory = DataCategory_FEATURE;
+      // For the following pixel format, there is another case which we don't handle
+      // in current configure design:
+      //
+      //   Under image mode and DLA_PRECISION == PRECISION_INT16, pixel format should
+      //   be NVDLA_PIXEL_FORMAT_A16B16G16R16
+      //
+      tle.pixelFormat  = INPUT_PIXEL_FORMAT;
+      tle.pixelMapping = 0;
+
+      tle.stride[0] = cubeinfo.stride_channel;
+      tle.stride[1] = cubeinfo.stride_line;
+      tle.stride[2] = cubeinfo.stride_surface;
+      tle.stride[3] = 0;
+      tle.stride[4] = 0;
+      tle.stride[5] = 0;
+      tle.stride[6] = 0;
+      tle.stride[7] = 0;
+
+      m_pMeta->m_TensorDescListEntries.emplace(m_pMeta->m_TensorDescListEntries.begin(), tle);
+    } else if (isOutput(tensor)) {
+      const NvDlaBackendMeta::MemoryFlags flags    = ILoadable::MemoryFlags_ALLOC | ILoadable::MemoryFlags_OUTPUT;
+      MemoryListEntryId                   memoryId = NvDlaBackendMeta::getInvalidMemoryListEntryId();
+      if (m_pMeta->shouldOwnMemory(*tensor)) {
+        memoryId = m_pMeta->allocateMemoryFor(*tensor, ILoadable::MemoryDomain_SYSMEM, flags, cubeinfo.size,
+                                              true /* is output */);
+      } else {
+        NvDlaBackendMeta::MemoryListEntry& memory = m_pMeta->getMemoryListEntry(*tensor);
+
+        memory.tensor_desc_id = 1; // mark this MemoryListEntry is for output
+        memory.flags          = flags;
+        memoryId              = memory.id;
+      }
+      assert(memoryId != NvDlaBackendMeta::getInvalidMemoryListEntryId());
+
+      ILoadable::TensorDescListEntry tle;
+      tle.name   = "probe";
+      tle.id     = 1;
+      tle.memId  = memoryId;
+      tle.size   = m_pMeta->getMemoryListEntrySize(memoryId);
+      tle.offset = 0;
+
+      tle.dims.n       = cubeinfo.dim_n;
+      tle.dims.c       = cubeinfo.dim_c;
+      tle.dims.h       = cubeinfo.dim_h;
+      tle.dims.w       = cubeinfo.dim_w;
+      tle.dataFormat   = 3;
+      tle.dataType     = DATA_TYPE;
+      tle.dataCategory = DataCategory_FEATURE;
+      tle.pixelFormat  = OUTPUT_PIXEL_FORMAT;
+      tle.pixelMapping = 0;
+
+      tle.stride[0] = cubeinfo.stride_channel;
+      tle.stride[1] = cubeinfo.stride_line;
+      tle.stride[2] = cubeinfo.stride_surface;
+      tle.stride[3] = 0;
+      tle.stride[4] = 0;
+      tle.stride[5] = 0;
+      tle.stride[6] = 0;
+      tle.stride[7] = 0;
+
+      m_pMeta->m_TensorDescListEntries.push_back(tle);
+    } else if ((m_Strategy != NvDlaMemAllocStrategy::kSeparate || m_Budget != 0) &&
+               outputSources.find(tensor) == end(outputSources)) {
+      arenaTensors.emplace_back(tensor);
+    } else {
+      m_pMeta->tryAllocateMemoryFor(*tensor, ILoadable::MemoryDomain_SYSMEM, ILoadable::MemoryFlags_ALLOC,
+                                    cubeinfo.size);
+    }
+  }
+
+  if (!arenaTensors.empty() || m_Budget != 0) {
+    if (!allocateActivations(pModule, arenaTensors)) {
+      return Pass::kPassFailure;
+    }
+  }
+  return Pass::kModuleNoChanged;
+}
+
+bool NvDlaMemInfoPass::allocateActivations(Module& pModule, const std::vector<const Tensor*>& pTensors)
+{
+  const OperatorList graphOrder = NvDlaLiveness::getOperatorList(*pModule.getRootComputeGraph());
+  OperatorList       order      = (m_pMeta->m_OperatorSchedule.empty() ? graphOrder : m_pMeta->m_OperatorSchedule);
+
+  std::vector<Interval> intervals = getIntervals(order, pTensors);
+  const Size            peak      = internal::getPeakBytes(intervals, order.size());
+
+  // compare against the other strategies
+  const NvDlaMemAllocator allocator(FEATURE_ATOM_CUBE_SIZE, 4096);
+  std::cout << "NvDlaMemInfoPass: " << pTensors.size() << " activation tensors, peak live bytes " << peak << "\n";
+  for (NvDlaMemAllocStrategy strategy : {NvDlaMemAllocStrategy::kSeparate, NvDlaMemAllocStrategy::kFirstFit,
+                                         NvDlaMemAllocStrategy::kBestFit, NvDlaMemAllocStrategy::kGreedyBySize}) {
+    const NvDlaMemAllocator::Result result = allocator.allocate(strategy, intervals);
+    std::cout << "  " << NvDlaMemAllocator::getName(strategy) << ": arena " << result.arenaSize
+              << " bytes, fragmentation " << NvDlaMemAllocator::getFragmentation(result, peak) << "\n";
+  }
+
+  NvDlaMemAllocStrategy     strategy = m_Strategy;
+  NvDlaMemAllocator::Result result   = allocator.allocate(strategy, intervals);
+  if (m_Budget != 0) {
+    const Size fixedBytes = getFixedBytes(pModule);
+    const Size limit      = (fixedBytes < m_Budget ? m_Budget - fixedBytes : 0);
+    std::cout << "NvDlaMemInfoPass: DRAM budget " << m_Budget << " bytes, weights and I/O " << fixedBytes
+              << " bytes, activations " << result.arenaSize << " bytes\n";
+
+    // 1. schedule: the peak-memory order of NvDlaTensorSchedPass, or the graph
+    //    order, may pack better than the scheduled one
+    if (limit < result.arenaSize) {
+      const OperatorList memoryOrder = NvDlaTensorSchedPass::scheduleForMemory(*this, graphOrder);
+      for (const OperatorList* otherOrder : {&memoryOrder, &graphOrder}) {
+        if (*otherOrder == order) {
+          continue;
+        }
+
+        std::vector<Interval>           otherIntervals = getIntervals(*otherOrder, pTensors);
+        const NvDlaMemAllocator::Result otherResult    = allocator.allocate(strategy, otherIntervals);
+        std::cout << "  try " << (otherOrder == &memoryOrder ? "peak-memory" : "graph")
+                  << " schedule: activations " << otherResult.arenaSize << " bytes\n";
+        if (otherResult.arenaSize < result.arenaSize) {
+          order     = *otherOrder;
+          intervals = std::move(otherIntervals);
+          result    = otherResult;
+        }
+      }
+    }
+
+    // 2. alias: let tensors with disjoint live ranges share bytes
+    if (limit < result.arenaSize && strategy != NvDlaMemAllocStrategy::kMinimumArena) {
+      const NvDlaMemAllocator::Result packed = allocator.allocate(NvDlaMemAllocStrategy::kMinimumArena, intervals);
+      std::cout << "  try aliasing: activations " << packed.arenaSize << " bytes\n";
+      if (packed.arenaSize < result.arenaSize) {
+        strategy = NvDlaMemAllocStrategy::kMinimumArena;
+        result   = packed;
+      }
+    }
+
+    // 3. recompute: shorten long live ranges by computing tensors again
+    if (limit < result.arenaSize && strategy != NvDlaMemAllocStrategy::kSeparate) {
+      const std::size_t numOperators = order.size();
+      recompute(order, intervals, result, pTensors, strategy, limit);
+      std::cout << "  try recomputation of " << (order.size() - numOperators)
+                << " operators: activations " << result.arenaSize << " bytes\n";
+    }
+
+    if (limit < result.arenaSize) {
+      reportBudget(pModule, intervals, result, fixedBytes);
+      return false;
+    }
+
+    if (order != graphOrder) {
+      m_pMeta->m_OperatorSchedule = order;
+    }
+  }
+
+  std::cout << "  selected " << NvDlaMemAllocator::getName(strategy) << ": arena " << result.arenaSize
+            << " bytes\n";
+
+  if (strategy == NvDlaMemAllocStrategy::kSeparate) {
+    for (const NvDlaMemAllocator::Placement& placement : result.placements) {
+      m_pMeta->tryAllocateMemoryFor(*placement.tensor, ILoadable::MemoryDomain_SYSMEM, ILoadable::MemoryFlags_ALLOC,
+                                    placement.size);
+    }
+    return true;
+  }
+
+  if (result.placements.empty()) {
+    return true;
+  }
+
+  const MemoryListEntryId memoryId =
+    m_pMeta->allocateMemory(ILoadable::MemoryDomain_SYSMEM, ILoadable::MemoryFlags_ALLOC, result.arenaSize);
+  for (const NvDlaMemAllocator::Placement& placement : result.placements) {
+    m_pMeta->bindMemoryFor(*placement.tensor, memoryId, placement.offset, placement.size);
+  }
+  return true;
+}
+
+std::vector<NvDlaMemInfoPass::Interval>
+NvDlaMemInfoPass::getIntervals(const OperatorList& pOrder, const std::vector<const Tensor*>& pTensors) const
+{
+  const NvDlaLiveness liveness(*this, pOrder);
+
+  // Reshape's output shares memory with its input, so the input has to live
+  // until the last use of the output.
+  std::unordered_map<const Tensor*, std::vector<Interval>> intervalTable;
+  for (const Tensor* tensor : pTensors) {
+    intervalTable.emplace(tensor, std::vector<Interval>{});
+  }
+  for (const Interval& interval : liveness.getIntervals()) {
+    const Tensor* owner = getOwner(*interval.tensor);
+
+    const auto found = intervalTable.find(owner);
+    if (found != end(intervalTable)) {
+      found->second.push_back(Interval{owner, interval.start, interval.end, liveness.getTensorSize(*owner)});
+    }
+  }
+
+  std::vector<Interval> intervals;
+  for (const Tensor* tensor : pTensors) {
+    const std::vector<Interval>& found = intervalTable.find(tensor)->second;
+    if (found.empty()) { // not in the operator order, keep it live all the time
+      const std::size_t lastStep = (pOrder.empty() ? 0 : pOrder.size() - 1);
+      intervals.push_back(Interval{tensor, 0, lastStep, liveness.getTensorSize(*tensor)});
+      continue;
+    }
+    intervals.insert(end(intervals), begin(found), end(found));
+  }
+  return intervals;
+}
+
+void NvDlaMemInfoPass::recompute(OperatorList& pOrder, std::vector<Interval>& pIntervals,
+                                 NvDlaMemAllocator::Result& pResult, const std::vector<const Tensor*>& pTensors,
+                                 NvDlaMemAllocStrategy pStrategy, Size pLimit) const
+{
+  const NvDlaMemAllocator allocator(FEATURE_ATOM_CUBE_SIZE, 4096);
+
+  const std::unordered_set<const Tensor*> arenaTensors(begin(pTensors), end(pTensors));
+  for (std::size_t iteration = 0; iteration < pTensors.size() && pLimit < pResult.arenaSize; ++iteration) {
+    const std::size_t peakStep = internal::getPeakStep(pIntervals, pOrder.size());
+
+    // A tensor live across the peak without being used there is freed after
+    // its last use before the peak, and computed again right before its
+    // first use after the peak. Only operators whose inputs are all
+    // activations which are still live at that point are recomputed, so no
+    // other live range and no weight blob grows.
+    OperatorList              bestOrder;
+    std::vector<Interval>     bestIntervals;
+    NvDlaMemAllocator::Result bestResult = pResult;
+    for (const Interval& interval : pIntervals) {
+      if (!(interval.start < peakStep && peakStep < interval.end)) {
+        continue;
+      }
+
+      ComputeOperator* producer = pOrder[interval.start];
+      if (isa<InputOperator>(producer) || isa<Initializer>(producer) || producer->getNumOfOutputs() != 1 ||
+          getOwner(*static_cast<const Tensor*>(producer->getOutput(0))) != interval.tensor) {
+        continue;
+      }
+
+      std::size_t useStep = pOrder.size();
+      bool        isUsedAtPeak = false;
+      for (std::size_t step = interval.start + 1; step <= interval.end; ++step) {
+        if (!internal::isUsing(*pOrder[step], *interval.tensor, *m_pMeta)) {
+          continue;
+        }
+        isUsedAtPeak |= (step == peakStep);
+        if (peakStep < step) {
+          useStep = std::min(useStep, step);
+        }
+      }
+      if (isUsedAtPeak || useStep == pOrder.size()) {
+        continue;
+      }
+
+      bool isCheap = true;
+      for (unsigned idx = 0; idx < producer->getNumOfInputs() && isCheap; ++idx) {
+        const Tensor* input = static_cast<const Tensor*>(producer->getInput(idx));
+        if (isConstant(*input)) {
+          isCheap = false;
+        } else if (arenaTensors.count(getOwner(*input)) != 0) {
+          isCheap = std::any_of(begin(pIntervals), end(pIntervals), [&](const Interval& other) {
+            return other.tensor == getOwner(*input) && other.start <= useStep && useStep <= other.end;
+          });
+        }
+      }
+      if (!isCheap) {
+        continue;
+      }
+
+      OperatorList order = pOrder;
+      order.insert(begin(order) + useStep, producer);
+
+      std::vector<Interval>           intervals = getIntervals(order, pTensors);
+      const NvDlaMemAllocator::Result result    = allocator.allocate(pStrategy, intervals);
+      if (result.arenaSize < bestResult.arenaSize) {
+        bestOrder     = std::move(order);
+        bestIntervals = std::move(intervals);
+        bestResult    = result;
+      }
+    }
+
+    if (bestOrder.empty()) {
+      break;
+    }
+
+    pOrder     = std::move(bestOrder);
+    pIntervals = std::move(bestIntervals);
+    pResult    = bestResult;
+  }
+}
+
+NvDlaMemInfoPass::Size NvDlaMemInfoPass::getFixedBytes(Module& pModule) const
+{
+  // entries allocated so far (inputs, outputs, ...)
+  Size bytes = 0;
+  for (const ILoadable::MemoryListEntry& memory : m_pMeta->m_MemoryListEntries) {
+    bytes += memory.size;
+  }
+
+  // weights are packed in code emitting, estimate them by their ATOM aligned size
+  for (ComputeOperator& cm : *pModule.getRootComputeGraph()) {
+    if (isa<Initializer>(&cm)) {
+      bytes += getWeightBytes(*static_cast<const Tensor*>(cm.getOutput(0)));
+    }
+  }
+  return bytes;
+}
+
+NvDlaMemInfoPass::Size NvDlaMemInfoPass::getWeightBytes(const Tensor& pTensor) const
+{
+  Size numElements = 1;
+  for (Tensor::Dimension dimension : pTensor.getDimensions()) {
+    numElements *= dimension;
+  }
+  return UNIT_ALIGNMENT(numElements * ELEMENT_SIZE, WEIGHT_ATOM_CUBE_SIZE);
+}
+
+const Tensor* NvDlaMemInfoPass::getOwner(const Tensor& pTensor) const
+{
+  return (m_pMeta->isReshaped(pTensor) ? &m_pMeta->getReshapeSource(pTensor) : &pTensor);
+}
+
+void NvDlaMemInfoPass::reportBudget(Module& pModule, const std::vector<Interval>& pIntervals,
+                                    const NvDlaMemAllocator::Result& pResult, Size pFixedBytes) const
+{
+  struct Entry
+  {
+    std::string name;
+    std::string kind;
+    Size        size;
+    std::string live;
+  };
+
+  std::vector<Entry> entries;
+  for (ComputeOperator& cm : *pModule.getRootComputeGraph()) {
+    for (unsigned idx = 0; idx < cm.getNumOfOutputs(); ++idx) {
+      const Tensor* tensor = static_cast<const Tensor*>(cm.getOutput(idx));
+      if (isa<Initializer>(&cm)) {
+        entries.push_back(Entry{tensor->getName(), "weight", getWeightBytes(*tensor), "-"});
+      } else if (m_pMeta->hasMemoryListEntry(*tensor) && getOwner(*tensor) == tensor) {
+        entries.push_back(Entry{tensor->getName(), (isa<InputOperator>(&cm) ? "input" : "output"),
+                                m_pMeta->getMemoryListEntrySize(*tensor), "-"});
+      }
+    }
+  }
+  for (const NvDlaMemAllocator::Placement& placement : pResult.placements) {
+    std::ostringstream live;
+    for (const Interval& interval : pIntervals) {
+      if (interval.tensor == placement.tensor) {
+        live << "[" << interval.start << "," << interval.end << "]";
+      }
+    }
+    entries.push_back(Entry{placement.tensor->getName(), "activation", placement.size, live.str()});
+  }
+  std::stable_sort(begin(entries), end(entries),
+                   [](const Entry& lhs, const Entry& rhs) { return lhs.size > rhs.size; });
+
+  errs() << "NvDlaMemInfoPass: cannot fit in DRAM budget " << m_Budget << " bytes, needs "
+         << (pFixedBytes + pResult.arenaSize) << " bytes (weights and I/O " << pFixedBytes << ", activation arena "
+         << pResult.arenaSize << ")\n";
+  errs() << "  " << std::left << std::setw(32) << "tensor" << std::setw(12) << "kind" << std::setw(12) << "bytes"
+         << "live steps\n";
+  for (const Entry& entry : entries) {
+    errs() << "  " << std::left << std::setw(32) << entry.name << std::setw(12) << entry.kind << std::setw(12)
+           << entry.size << entry.live << "\n";
+  }
+}
+} // namespace foonvdla
+} // namespace onnc
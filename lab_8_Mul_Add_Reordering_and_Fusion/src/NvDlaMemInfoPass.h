@@ -0,0 +1,65 @@
+//===- NvDlaMemInfoPass.h -------------------------------------------------===//
+//
+//                             The ONNC Project
+//
+// See LICENSE.TXT for details.
+//
+//===----------------------------------------------------------------------===//
+#ifndef ONNC_NVDLAMEMINFO_PASS_H
+#define ONNC_NVDLAMEMINFO_PASS_H
+
+#include "NvDlaDefine.h"
+#include "NvDlaMemAllocator.h"
+#include "NvDlaMeta.h"
+
+#include <onnc/Core/CustomPass.h>
+
+namespace onnc {
+namespace foonvdla {
+/** \class NvDlaMemInfoPass
+ *  \brief Allocate memory for tensors
+ */
+class NvDlaMemInfoPass : public CustomPass<NvDlaMemInfoPass>, private NvDlaConstants
+{
+public:
+  using Size         = NvDlaLiveness::Size;
+  using Interval     = NvDlaLiveness::Interval;
+  using OperatorList = NvDlaLiveness::OperatorList;
+
+public:
+  /// @param budget DRAM bytes for weights, I/O and activations, 0 for no limit
+  NvDlaMemInfoPass(const NvDlaConstants& constants, NvDlaBackendMeta* pMeta,
+                   NvDlaMemAllocStrategy strategy = NvDlaMemAllocStrategy::kSeparate, Size budget = 0) noexcept;
+
+  ReturnType runOnModule(Module& pModule) override;
+
+private:
+  /// Allocate intermediate tensors. If they do not fit in the budget, try the
+  /// peak-memory operator order, aliasing and recomputation in turn. Returns
+  /// false if nothing fits.
+  bool allocateActivations(Module& pModule, const std::vector<const Tensor*>& pTensors);
+
+  std::vector<Interval> getIntervals(const OperatorList& pOrder, const std::vector<const Tensor*>& pTensors) const;
+
+  void recompute(OperatorList& pOrder, std::vector<Interval>& pIntervals, NvDlaMemAllocator::Result& pResult,
+                 const std::vector<const Tensor*>& pTensors, NvDlaMemAllocStrategy pStrategy, Size pLimit) const;
+
+  /// Bytes of allocated entries and (estimated) weight blobs.
+  Size getFixedBytes(Module& pModule) const;
+
+  Size getWeightBytes(const Tensor& pTensor) const;
+
+  const Tensor* getOwner(const Tensor& pTensor) const;
+
+  void reportBudget(Module& pModule, const std::vector<Interval>& pIntervals, const NvDlaMemAllocator::Result& pResult,
+                    Size pFixedBytes) const;
+
+private:
+  NvDlaBackendMeta*     m_pMeta;
+  NvDlaMemAllocStrategy m_Strategy;
+  Size                  m_Budget;
+};
+} // namespace foonvdla
+} // namespace onnc
+
+#endif
@@ -0,0 +1,175 @@
+//===- NvDlaPartitionPass.cpp ---------------------------------------------===//
+//
+//                             The ONNC Project
+//
+// See LICENSE.TXT for details.
+//
+//===----------------------------------------------------------------------===//
+#include "NvDlaPartitionPass.h"
+
+#include "NvDlaEngine.h"
+
+#include <onnc/Core/PassSupport.h>
+#include <onnc/IR/ComputeOperator.h>
+
+#include <algorithm>
+#include <cmath>
+#include <iomanip>
+#include <iostream>
+
+namespace onnc {
+namespace foonvdla {
+
+namespace internal {
+
+// cycles for one core to signal the other between task entries
+const NvDlaPerfModel::Cycles kSyncCycles = 2000;
+
+const unsigned kNumCores = 2;
+
+} // namespace internal
+
+//===----------------------------------------------------------------------===//
+// NvDlaPartitionPass
+//===----------------------------------------------------------------------===//
+NvDlaPartitionPass::NvDlaPartitionPass(const NvDlaConstants& constants, NvDlaBackendMeta* pMeta,
+                                       const NvDlaPerfModel& perfModel, NvDlaPartitionMode mode,
+                                       bool streaming) noexcept
+  : NvDlaConstants{constants}
+  , m_pMeta{pMeta}
+  , m_PerfModel{perfModel}
+  , m_Mode{mode}
+  , m_Streaming{streaming}
+{}
+
+Pass::ReturnType NvDlaPartitionPass::runOnModule(Module& pModule)
+{
+  using internal::kNumCores;
+
+  if (m_Mode == NvDlaPartitionMode::kNone) {
+    return Pass::kModuleNoChanged;
+  }
+
+  if (!m_Streaming) {
+    std::cout << "NvDlaPartitionPass: pipeline split needs streaming, keep every operator on core 0\n";
+    return Pass::kModuleNoChanged;
+  }
+
+  const OperatorList order = (m_pMeta->m_OperatorSchedule.empty()
+                                ? NvDlaLiveness::getOperatorList(*pModule.getRootComputeGraph())
+                                : m_pMeta->m_OperatorSchedule);
+
+  Cycles serialCycles = 0;
+  for (const ComputeOperator* op : order) {
+    serialCycles += m_PerfModel.estimate(*op).cycles;
+  }
+
+  const Partition partition = partitionByStage(order);
+
+  Cycles coreCycles[kNumCores] = {0};
+  for (const ComputeOperator* op : order) {
+    coreCycles[partition.cores.at(op)] += m_PerfModel.estimate(*op).cycles;
+  }
+
+  const double speedup = (partition.cycles == 0 ? 1.0 : static_cast<double>(serialCycles) / partition.cycles);
+  std::cout << "NvDlaPartitionPass: pipeline split, core cycles " << coreCycles[0] << " / " << coreCycles[1]
+            << ", cross-core bytes " << partition.crossBytes << ", estimated throughput speedup " << std::fixed
+            << std::setprecision(2) << speedup << "x\n";
+
+  if (partition.cycles >= serialCycles) {
+    std::cout << "NvDlaPartitionPass: no speedup, keep every operator on core 0\n";
+    return Pass::kModuleNoChanged;
+  }
+
+  m_pMeta->m_OperatorCores = partition.cores;
+  return Pass::kModuleNoChanged;
+}
+
+NvDlaPartitionPass::Partition NvDlaPartitionPass::partitionByStage(const OperatorList& pOrder) const
+{
+  std::vector<Cycles> prefixCycles(pOrder.size() + 1, 0);
+  for (std::size_t idx = 0; idx < pOrder.size(); ++idx) {
+    prefixCycles[idx + 1] = prefixCycles[idx] + m_PerfModel.estimate(*pOrder[idx]).cycles;
+  }
+  const std::vector<Bytes> crossBytes = getCrossBytes(pOrder);
+
+  // every cut of a topological order is a valid two-stage pipeline, the slower
+  // stage plus the hand-over bounds the throughput
+  std::size_t bestCut = 0;
+  Partition   best;
+  best.cycles = prefixCycles.back();
+  for (std::size_t cut = 1; cut < pOrder.size(); ++cut) {
+    const Cycles firstStage  = prefixCycles[cut];
+    const Cycles secondStage = prefixCycles.back() - prefixCycles[cut];
+    const Cycles cycles      = std::max(firstStage, secondStage) + getTransferCycles(crossBytes[cut]);
+    if (bestCut == 0 || cycles < best.cycles || (cycles == best.cycles && crossBytes[cut] < best.crossBytes)) {
+      bestCut         = cut;
+      best.cycles     = cycles;
+      best.crossBytes = crossBytes[cut];
+    }
+  }
+
+  // with fewer than two operators there is no cut, all stay on core 0
+  for (std::size_t idx = 0; idx < pOrder.size(); ++idx) {
+    best.cores.emplace(pOrder[idx], idx < bestCut ? 0 : 1);
+  }
+  return best;
+}
+
+std::vector<NvDlaPartitionPass::Bytes> NvDlaPartitionPass::getCrossBytes(const OperatorList& pOrder) const
+{
+  std::unordered_map<const ComputeOperator*, std::size_t> positions;
+  for (std::size_t idx = 0; idx < pOrder.size(); ++idx) {
+    positions.emplace(pOrder[idx], idx);
+  }
+
+  // A tensor produced at position p and last read on an engine at position q
+  // crosses every cut in (p, q], once however many users the other core has.
+  // Add it to a difference array and sum the prefixes.
+  std::vector<Bytes> crossBytes(pOrder.size() + 1, 0);
+  for (std::size_t producer = 0; producer < pOrder.size(); ++producer) {
+    const ComputeOperator* op = pOrder[producer];
+    if (NvDlaEngineModel::getEngine(*op) == NvDlaEngine::kNone) {
+      continue;
+    }
+
+    for (unsigned idx = 0; idx < op->getNumOfOutputs(); ++idx) {
+      const Tensor* output = dynamic_cast<const Tensor*>(op->getOutput(idx));
+      if (output == nullptr || !NvDlaLiveness::isActivation(*output)) {
+        continue;
+      }
+
+      std::size_t lastUser = producer;
+      for (const auto& use : output->getUses()) {
+        const auto found = positions.find(use.getUser());
+        if (found != positions.end() && NvDlaEngineModel::getEngine(*use.getUser()) != NvDlaEngine::kNone) {
+          lastUser = std::max(lastUser, found->second);
+        }
+      }
+      if (lastUser == producer) {
+        continue;
+      }
+
+      const Bytes size = NvDlaLiveness::getTensorSize(*this, *output);
+      crossBytes[producer + 1] += size;
+      crossBytes[lastUser + 1] -= size;
+    }
+  }
+
+  for (std::size_t cut = 1; cut < crossBytes.size(); ++cut) {
+    crossBytes[cut] += crossBytes[cut - 1];
+  }
+  return crossBytes;
+}
+
+NvDlaPartitionPass::Cycles NvDlaPartitionPass::getTransferCycles(Bytes bytes) const
+{
+  if (bytes == 0) {
+    return 0;
+  }
+
+  return internal::kSyncCycles + static_cast<Cycles>(std::ceil(bytes / m_PerfModel.getDramBytesPerCycle()));
+}
+
+} // namespace foonvdla
+} // namespace onnc
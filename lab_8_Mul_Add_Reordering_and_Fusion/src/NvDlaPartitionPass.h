@@ -0,0 +1,86 @@
+//===- NvDlaPartitionPass.h -----------------------------------------------===//
+//
+//                             The ONNC Project
+//
+// See LICENSE.TXT for details.
+//
+//===----------------------------------------------------------------------===//
+#ifndef ONNC_FOONVDLA_PARTITION_PASS_H
+#define ONNC_FOONVDLA_PARTITION_PASS_H
+#include "NvDlaDefine.h"
+#include "NvDlaLiveness.h"
+#include "NvDlaMeta.h"
+#include "NvDlaPerfModel.h"
+
+#include <onnc/Core/CustomPass.h>
+
+#include <unordered_map>
+#include <vector>
+
+namespace onnc {
+namespace foonvdla {
+
+enum class NvDlaPartitionMode : unsigned
+{
+  kNone = 0, // every operator on core 0
+  kPipeline  // a prefix of the schedule on core 0 and the rest on core 1, for streaming
+};
+
+/** \class NvDlaPartitionPass
+ *  \brief Split the scheduled operators across two NVDLA cores.
+ *
+ *  The chosen core of each operator is recorded in
+ *  NvDlaBackendMeta::m_OperatorCores. A tensor crossing cores costs a
+ *  synchronization between task entries plus reading it back from DRAM, so
+ *  cuts with fewer cross-core bytes are preferred. The expected speedup over
+ *  one core is given by NvDlaPerfModel; the split is dropped if there is no
+ *  speedup.
+ *
+ *  The two stages only overlap when NvDlaTaskSubmitPass pipelines two frames,
+ *  so kPipeline does nothing without streaming. A mode splitting independent
+ *  branches of one frame is deferred: each task entry is submitted on its own,
+ *  so the cores would still run one after the other until the task entries of
+ *  both cores can be submitted together.
+ */
+class NvDlaPartitionPass : public CustomPass<NvDlaPartitionPass>, private NvDlaConstants
+{
+public:
+  using OperatorList = NvDlaLiveness::OperatorList;
+  using Cycles       = NvDlaPerfModel::Cycles;
+  using Bytes        = NvDlaPerfModel::Bytes;
+  using CoreMap      = std::unordered_map<const ComputeOperator*, unsigned>;
+
+  struct Partition
+  {
+    CoreMap cores;
+    Bytes   crossBytes = 0;
+    Cycles  cycles     = 0; // pipeline period
+  };
+
+public:
+  NvDlaPartitionPass(const NvDlaConstants& constants, NvDlaBackendMeta* pMeta, const NvDlaPerfModel& perfModel,
+                     NvDlaPartitionMode mode, bool streaming) noexcept;
+
+  ReturnType runOnModule(Module& pModule) override;
+
+private:
+  Partition partitionByStage(const OperatorList& pOrder) const;
+
+  /// Activation bytes crossing each cut of @ref pOrder, where cut c puts the
+  /// first c operators on core 0 and the rest on core 1.
+  std::vector<Bytes> getCrossBytes(const OperatorList& pOrder) const;
+
+  /// Cycles to synchronize the cores and read @ref bytes back from DRAM.
+  Cycles getTransferCycles(Bytes bytes) const;
+
+private:
+  NvDlaBackendMeta*  m_pMeta;
+  NvDlaPerfModel     m_PerfModel;
+  NvDlaPartitionMode m_Mode;
+  bool               m_Streaming;
+};
+
+} // namespace foonvdla
+} // namespace onnc
+
+#endif
@@ -0,0 +1,152 @@
+//===- NvDlaPassProfiler.cpp ----------------------------------------------===//
+//
+//                             The ONNC Project
+//
+// See LICENSE.TXT for details.
+//
+//===----------------------------------------------------------------------===//
+#include "NvDlaPassProfiler.h"
+
+#include <onnc/IR/ComputeGraph.h>
+#include <onnc/IR/ComputeOperator.h>
+
+#include <sys/resource.h>
+#include <unistd.h>
+
+#include <fstream>
+#include <iomanip>
+#include <unordered_set>
+
+namespace onnc {
+namespace foonvdla {
+
+//===----------------------------------------------------------------------===//
+// NvDlaPassProfiler
+//===----------------------------------------------------------------------===//
+void NvDlaPassProfiler::checkpoint(const std::string& pName, Module& pModule)
+{
+  Sample current;
+  current.time      = Clock::now();
+  current.peakRssKB = getPeakRssKB();
+  current.rssKB     = getRssKB();
+  countGraph(pModule, current.numOps, current.numValues);
+
+  if (m_HasStarted) {
+    NvDlaPassProfile profile;
+    profile.name            = pName;
+    profile.milliseconds    = std::chrono::duration<double, std::milli>(current.time - m_Last.time).count();
+    profile.peakRssKB       = current.peakRssKB;
+    profile.rssKB           = current.rssKB;
+    profile.rssDeltaKB      = current.rssKB - m_Last.rssKB;
+    profile.numOpsBefore    = m_Last.numOps;
+    profile.numOpsAfter     = current.numOps;
+    profile.numValuesBefore = m_Last.numValues;
+    profile.numValuesAfter  = current.numValues;
+    m_Profiles.emplace_back(profile);
+  }
+
+  // the next pass starts after the graph is counted
+  m_HasStarted = true;
+  m_Last       = current;
+  m_Last.time  = Clock::now();
+}
+
+void NvDlaPassProfiler::report(std::ostream& os) const
+{
+  double total = 0.0;
+  for (const NvDlaPassProfile& profile : m_Profiles) {
+    total += profile.milliseconds;
+  }
+
+  os << std::left << std::setw(40) << "pass" << std::right << std::setw(12) << "time (ms)" << std::setw(8) << "%"
+     << std::setw(14) << "peak RSS (KB)" << std::setw(10) << "RSS (KB)" << std::setw(10) << "RSS +/-"
+     << std::setw(16) << "operators" << std::setw(16) << "values" << "\n";
+
+  for (const NvDlaPassProfile& profile : m_Profiles) {
+    const std::string ops    = std::to_string(profile.numOpsBefore) + " -> " + std::to_string(profile.numOpsAfter);
+    const std::string values =
+      std::to_string(profile.numValuesBefore) + " -> " + std::to_string(profile.numValuesAfter);
+    os << std::left << std::setw(40) << profile.name << std::right << std::fixed << std::setprecision(3)
+       << std::setw(12) << profile.milliseconds << std::setprecision(1) << std::setw(7)
+       << (total == 0.0 ? 0.0 : profile.milliseconds * 100 / total) << "%" << std::setw(14) << profile.peakRssKB
+       << std::setw(10) << profile.rssKB << std::setw(10) << profile.rssDeltaKB << std::setw(16) << ops
+       << std::setw(16) << values << "\n";
+  }
+  os << std::left << std::setw(40) << "total" << std::right << std::fixed << std::setprecision(3) << std::setw(12)
+     << total << "\n";
+}
+
+void NvDlaPassProfiler::writeJson(std::ostream& os) const
+{
+  // pass names are given by the backend, only quotes and backslashes are escaped
+  auto quote = [](const std::string& text) {
+    std::string result = "\"";
+    for (char c : text) {
+      if (c == '"' || c == '\\') {
+        result += '\\';
+      }
+      result += c;
+    }
+    return result + "\"";
+  };
+
+  os << "{\n  \"passes\": [";
+  for (std::size_t idx = 0; idx < m_Profiles.size(); ++idx) {
+    const NvDlaPassProfile& profile = m_Profiles[idx];
+    os << (idx == 0 ? "\n" : ",\n") << "    {\"name\": " << quote(profile.name) << ", \"wall_ms\": " << std::fixed
+       << std::setprecision(3) << profile.milliseconds << ", \"peak_rss_kb\": " << profile.peakRssKB
+       << ", \"rss_kb\": " << profile.rssKB << ", \"rss_delta_kb\": " << profile.rssDeltaKB
+       << ", \"operators_before\": " << profile.numOpsBefore
+       << ", \"operators_after\": " << profile.numOpsAfter << ", \"values_before\": " << profile.numValuesBefore
+       << ", \"values_after\": " << profile.numValuesAfter << "}";
+  }
+  os << "\n  ]\n}\n";
+}
+
+long NvDlaPassProfiler::getPeakRssKB()
+{
+  // ru_maxrss is in kilobytes on Linux
+  struct rusage usage;
+  if (getrusage(RUSAGE_SELF, &usage) != 0) {
+    return 0;
+  }
+  return usage.ru_maxrss;
+}
+
+long NvDlaPassProfiler::getRssKB()
+{
+  // the second field is the # of resident pages
+  std::ifstream statm("/proc/self/statm");
+  long          numPages = 0, numResidentPages = 0;
+  if (!(statm >> numPages >> numResidentPages)) {
+    return 0;
+  }
+  return numResidentPages * (sysconf(_SC_PAGESIZE) / 1024);
+}
+
+void NvDlaPassProfiler::countGraph(Module& pModule, std::size_t& numOps, std::size_t& numValues)
+{
+  std::unordered_set<const Value*> values;
+
+  // there is no ONNC IR before tensor selection
+  numOps    = 0;
+  numValues = 0;
+  ComputeGraph* graph = pModule.getRootComputeGraph();
+  if (graph == nullptr) {
+    return;
+  }
+
+  for (ComputeOperator& op : *graph) {
+    ++numOps;
+    for (unsigned idx = 0; idx < op.getNumOfInputs(); ++idx) {
+      values.insert(op.getInput(idx));
+    }
+    for (unsigned idx = 0; idx < op.getNumOfOutputs(); ++idx) {
+      values.insert(op.getOutput(idx));
+    }
+  }
+  numValues = values.size();
+}
+
+} // namespace foonvdla
+} // namespace onnc
@@ -0,0 +1,90 @@
+//===- NvDlaPassProfiler.h ------------------------------------------------===//
+//
+//                             The ONNC Project
+//
+// See LICENSE.TXT for details.
+//
+//===----------------------------------------------------------------------===//
+#ifndef TARGET_FOONVDLA_NVDLA_PASS_PROFILER_H
+#define TARGET_FOONVDLA_NVDLA_PASS_PROFILER_H
+
+#include <onnc/IR/Module.h>
+
+#include <chrono>
+#include <cstddef>
+#include <ostream>
+#include <string>
+#include <vector>
+
+namespace onnc {
+namespace foonvdla {
+
+struct NvDlaPassProfile
+{
+  std::string name;
+  double      milliseconds    = 0.0;
+  long        peakRssKB       = 0; // of the process so far, after the pass
+  long        rssKB           = 0; // resident now, after the pass
+  long        rssDeltaKB      = 0; // change of the resident size by the pass
+  std::size_t numOpsBefore    = 0;
+  std::size_t numOpsAfter     = 0;
+  std::size_t numValuesBefore = 0;
+  std::size_t numValuesAfter  = 0;
+};
+
+/** \class NvDlaPassProfiler
+ *  \brief Wall time, RSS and graph size of every pass in the pipeline.
+ *
+ *  NvDlaProfilePass is added after each profiled pass, and everything which
+ *  ran since the previous checkpoint is counted as that pass, so passes that
+ *  ONNC adds between the backend stages are counted in the next one. Counting
+ *  the graph is not part of the wall time. The peak RSS only grows over the
+ *  process lifetime, so the memory a pass adds or frees is the change of the
+ *  current RSS instead. Nothing is added to the pipeline if profiling is
+ *  disabled.
+ */
+class NvDlaPassProfiler
+{
+public:
+  using Clock = std::chrono::steady_clock;
+
+public:
+  /// Record what ran since the previous checkpoint as @ref pName. The first
+  /// checkpoint only starts the clock.
+  void checkpoint(const std::string& pName, Module& pModule);
+
+  const std::vector<NvDlaPassProfile>& getProfiles() const noexcept { return m_Profiles; }
+
+  /// Print one line per pass, and the total, in running order.
+  void report(std::ostream& os) const;
+
+  void writeJson(std::ostream& os) const;
+
+private:
+  struct Sample
+  {
+    Clock::time_point time;
+    long              peakRssKB = 0;
+    long              rssKB     = 0;
+    std::size_t       numOps    = 0;
+    std::size_t       numValues = 0;
+  };
+
+  static long getPeakRssKB();
+
+  /// Resident set size from /proc/self/statm, 0 if it is not available.
+  static long getRssKB();
+
+  /// # of operators and distinct values read or written by them in the root graph.
+  static void countGraph(Module& pModule, std::size_t& numOps, std::size_t& numValues);
+
+private:
+  bool                          m_HasStarted = false;
+  Sample                        m_Last;
+  std::vector<NvDlaPassProfile> m_Profiles;
+};
+
+} // namespace foonvdla
+} // namespace onnc
+
+#endif
@@ -0,0 +1,135 @@
+//===- NvDlaPattern.h -----------------------------------------------------===//
+//
+//                             The ONNC Project
+//
+// See LICENSE.TXT for details.
+//
+//===----------------------------------------------------------------------===//
+#ifndef TARGET_FOONVDLA_NVDLA_PATTERN_H
+#define TARGET_FOONVDLA_NVDLA_PATTERN_H
+
+#include <onnc/IR/ComputeGraph.h>
+#include <onnc/IR/ComputeOperator.h>
+
+#include <functional>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+namespace onnc {
+namespace foonvdla {
+
+/** \class NvDlaPattern
+ *  \brief A group of connected operators to be rewritten, e.g.
+ *
+ *  \code
+ *  NvDlaPattern("AddMulRelu").op<Add>().singleUse().op<Mul>().singleUse().op<Relu>();
+ *  \endcode
+ *
+ *  Nodes are appended by op(). Except for the root, a node is matched on the
+ *  users of an output of an earlier node, the previous one unless from() is
+ *  given. Constraints apply to the last appended node.
+ */
+class NvDlaPattern
+{
+public:
+  using Kind      = const void*;
+  using Predicate = std::function<bool(const ComputeOperator&)>;
+  using Operators = std::vector<ComputeOperator*>;
+
+public:
+  explicit NvDlaPattern(std::string name);
+
+  template <typename OpType>
+  NvDlaPattern& op()
+  {
+    return op(&OpType::ID);
+  }
+
+  NvDlaPattern& op(Kind kind);
+
+  /// Match the last node on the users of output @ref output of node @ref node.
+  NvDlaPattern& from(unsigned node, unsigned output = 0);
+
+  /// The first output of the last node has exactly one user.
+  NvDlaPattern& singleUse();
+
+  /// At least one input of the last node is defined by an Initializer.
+  NvDlaPattern& hasConstantInput();
+
+  /// An arbitrary condition on the last node, e.g. on its attributes.
+  NvDlaPattern& where(Predicate predicate);
+
+  const std::string& getName() const noexcept { return m_Name; }
+
+  Kind getRootKind() const;
+
+  unsigned getNumOfNodes() const noexcept { return m_Nodes.size(); }
+
+  /// Match the pattern rooted at @ref root. The matched operators are stored
+  /// in @ref operators by the node order.
+  bool match(ComputeOperator& root, Operators& operators) const;
+
+private:
+  struct Node
+  {
+    Kind                   kind;
+    unsigned               parent;
+    unsigned               output;
+    bool                   isSingleUse;
+    bool                   hasConstantInput;
+    std::vector<Predicate> predicates;
+  };
+
+  bool isMatched(const Node& node, const ComputeOperator& op) const;
+
+  bool matchFrom(unsigned idx, Operators& operators) const;
+
+private:
+  std::string       m_Name;
+  std::vector<Node> m_Nodes;
+};
+
+struct NvDlaPatternMatch
+{
+  const NvDlaPattern*     pattern;
+  unsigned                index;     // of the pattern in its NvDlaPatternSet
+  NvDlaPattern::Operators operators; // by the node order, the root first
+};
+
+/** \class NvDlaPatternSet
+ *  \brief Patterns compiled into one matcher.
+ *
+ *  Patterns are indexed by the kind of their root, so a graph is matched in
+ *  one traversal however many patterns there are. Patterns added earlier
+ *  take priority, and an operator belongs to one match at most.
+ */
+class NvDlaPatternSet
+{
+public:
+  using Match     = NvDlaPatternMatch;
+  using MatchList = std::vector<Match>;
+
+public:
+  NvDlaPatternSet& add(NvDlaPattern pattern);
+
+  /// Find the matches rooted at @ref root, by the pattern priority.
+  MatchList match(ComputeOperator& root) const;
+
+  /// Find non-overlapping matches by the graph order.
+  MatchList match(ComputeGraph& pCG) const;
+
+  bool empty() const noexcept { return m_Patterns.empty(); }
+
+  /// The largest # of operators in a pattern.
+  unsigned getMaxNumOfNodes() const;
+
+private:
+  std::vector<NvDlaPattern>                                    m_Patterns;
+  std::unordered_map<NvDlaPattern::Kind, std::vector<unsigned>> m_PatternsByRoot;
+};
+
+} // namespace foonvdla
+} // namespace onnc
+
+#endif
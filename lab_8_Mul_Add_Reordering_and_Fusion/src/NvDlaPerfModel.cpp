@@ -0,0 +1,241 @@
+//===- NvDlaPerfModel.cpp -------------------------------------------------===//
+//
+//                             The ONNC Project
+//
+// See LICENSE.TXT for details.
+//
+//===----------------------------------------------------------------------===//
+#include "NvDlaPerfModel.h"
+
+#include "NvDlaLiveness.h"
+#include "NvDlaUtil.h"
+
+#include <algorithm>
+#include <cassert>
+#include <cmath>
+#include <iomanip>
+
+namespace onnc {
+namespace foonvdla {
+
+namespace internal {
+
+NvDlaPerfModel::Bytes getNumOfElements(const Tensor& tensor)
+{
+  NvDlaPerfModel::Bytes numElements = 1;
+  for (Tensor::Dimension dimension : tensor.getDimensions()) {
+    numElements *= dimension;
+  }
+  return numElements;
+}
+
+NvDlaPerfModel::Bytes getNumOfElements(const dla_data_cube& cube)
+{
+  return static_cast<NvDlaPerfModel::Bytes>(cube.width) * cube.height * cube.channel;
+}
+
+/// Bytes moved from or to DRAM for a cube; address 0 is the dummy entry of unused cubes.
+NvDlaPerfModel::Bytes getDramBytes(const dla_data_cube& cube)
+{
+  return (0 < cube.address && cube.type == DLA_MEM_MC ? cube.size : 0);
+}
+
+NvDlaPerfModel::Bytes getDramBytes(const dla_sdp_op& op, const dla_data_cube& cube)
+{
+  // per-layer operands are in the descriptor
+  return (op.enable && op.mode != SDP_OP_PER_LAYER ? getDramBytes(cube) : 0);
+}
+
+} // namespace internal
+
+//===----------------------------------------------------------------------===//
+// NvDlaPerfModel
+//===----------------------------------------------------------------------===//
+NvDlaPerfModel::NvDlaPerfModel(const NvDlaConstants& constants, double dramBytesPerCycle) noexcept
+  : NvDlaConstants{constants}
+  , m_DramBytesPerCycle{dramBytesPerCycle}
+{
+  assert(0 < m_DramBytesPerCycle);
+}
+
+NvDlaPerfModel::Estimate NvDlaPerfModel::estimate(const ComputeOperator& op) const
+{
+  using internal::getNumOfElements;
+
+  const NvDlaEngine engine = NvDlaEngineModel::getEngine(op);
+  if (engine == NvDlaEngine::kNone) {
+    return Estimate{};
+  }
+
+  Bytes inputBytes = 0, constantBytes = 0, outputBytes = 0, numElements = 0;
+  for (unsigned idx = 0; idx < op.getNumOfInputs(); ++idx) {
+    if (const Tensor* input = dynamic_cast<const Tensor*>(op.getInput(idx))) {
+      (isConstant(*input) ? constantBytes : inputBytes) += NvDlaLiveness::getTensorSize(*this, *input);
+    }
+  }
+  for (unsigned idx = 0; idx < op.getNumOfOutputs(); ++idx) {
+    if (const Tensor* output = dynamic_cast<const Tensor*>(op.getOutput(idx))) {
+      outputBytes += NvDlaLiveness::getTensorSize(*this, *output);
+      numElements += getNumOfElements(*output);
+    }
+  }
+
+  switch (engine) {
+  case NvDlaEngine::kConv: {
+    // weight is [K, C / group, kh, kw], so each output element takes C / group * kh * kw MACs
+    const Tensor* weight = dynamic_cast<const Tensor*>(op.getInput(1));
+    assert(weight != nullptr && weight->getDimensions().size() == 4);
+
+    const Tensor::Dimensions& dims = weight->getDimensions();
+    const NvDlaCubeInfo       weightCube(*this, NVDLA_CUBE_WEIGHT, dims[0], dims[1], dims[2], dims[3]);
+    const Bytes               macs = numElements * (getNumOfElements(*weight) / dims[0]);
+
+    // CBUF is shared by input and weights, the input gets what weights leave
+    const Bytes    bankBytes   = static_cast<Bytes>(CBUF_BANK_WIDTH) * CBUF_BANK_DEPTH;
+    const unsigned weightBanks = std::min<Bytes>(DIV_ROUNDUP(weightCube.size, bankBytes), CBUF_BANK_NUM - 1);
+    const Bytes    numFetches  = getNumOfWeightFetches(inputBytes, weightCube.size, CBUF_BANK_NUM - weightBanks,
+                                                       weightBanks);
+    const Bytes    otherBytes  = (constantBytes > weightCube.size ? constantBytes - weightCube.size : 0);
+    return makeEstimate(engine, DIV_ROUNDUP(macs, static_cast<Bytes>(MAC_ATOMIC_C * MAC_ATOMIC_K)),
+                        inputBytes + weightCube.size * numFetches + otherBytes + outputBytes);
+  }
+  case NvDlaEngine::kEmu:
+  {
+    // the CPU handles one element at a time and its memory traffic is not modeled
+    Estimate result;
+    result.engine        = engine;
+    result.computeCycles = numElements;
+    result.cycles        = numElements;
+    return result;
+  }
+  default:
+    break;
+  }
+
+  return makeEstimate(engine, getCyclesForElements(numElements), inputBytes + constantBytes + outputBytes);
+}
+
+NvDlaPerfModel::Estimate NvDlaPerfModel::estimate(const NvDlaDlaOperation& operation) const
+{
+  using internal::getDramBytes;
+  using internal::getNumOfElements;
+
+  switch (operation.op_dep.op_type) {
+  case DLA_OP_BDMA: {
+    const dla_bdma_surface_desc& surface = operation.op_surf.bdma_surface;
+
+    Bytes dramBytes = 0;
+    for (std::uint16_t idx = 0; idx < surface.num_transfers; ++idx) {
+      const dla_bdma_transfer_desc& transfer = surface.transfers[idx];
+
+      const Bytes bytes = static_cast<Bytes>(transfer.line_size) * transfer.line_repeat *
+                          std::max<std::uint32_t>(transfer.surface_repeat, 1);
+      dramBytes += (surface.source_type == DLA_MEM_MC ? bytes : 0);
+      dramBytes += (surface.destination_type == DLA_MEM_MC ? bytes : 0);
+    }
+    // a pure copy engine, it is busy as long as the transfer lasts
+    Estimate result      = makeEstimate(NvDlaEngine::kBdma, 0, dramBytes);
+    result.computeCycles = result.memoryCycles;
+    return result;
+  }
+  case DLA_OP_CONV: {
+    const dla_conv_op_desc&      op      = operation.op_desc.conv_op;
+    const dla_conv_surface_desc& surface = operation.op_surf.conv_surface;
+
+    const Bytes macs = getNumOfElements(surface.dst_data) * op.kernel_width_csc * op.kernel_height_csc *
+                       op.kernel_channel_csc;
+    const Bytes numFetches =
+      getNumOfWeightFetches(surface.src_data.size, surface.weight_data.size, op.data_bank, op.weight_bank);
+    const Bytes dramBytes = getDramBytes(surface.src_data) + getDramBytes(surface.weight_data) * numFetches +
+                            getDramBytes(surface.wmb_data) + getDramBytes(surface.wgs_data) +
+                            getDramBytes(surface.dst_data);
+    return makeEstimate(NvDlaEngine::kConv, DIV_ROUNDUP(macs, static_cast<Bytes>(MAC_ATOMIC_C * MAC_ATOMIC_K)),
+                        dramBytes);
+  }
+  case DLA_OP_SDP: {
+    const dla_sdp_op_desc&      op      = operation.op_desc.sdp_op;
+    const dla_sdp_surface_desc& surface = operation.op_surf.sdp_surface;
+
+    const Bytes dramBytes = getDramBytes(surface.src_data) + getDramBytes(op.x1_op, surface.x1_data) +
+                            getDramBytes(op.x2_op, surface.x2_data) + getDramBytes(op.y_op, surface.y_data) +
+                            getDramBytes(surface.dst_data);
+    return makeEstimate(NvDlaEngine::kSdp, getCyclesForElements(getNumOfElements(surface.dst_data)), dramBytes);
+  }
+  case DLA_OP_PDP: {
+    // PDP reads every input element once, the pooling window is kept on-chip
+    const dla_pdp_surface_desc& surface = operation.op_surf.pdp_surface;
+    return makeEstimate(NvDlaEngine::kPdp, getCyclesForElements(getNumOfElements(surface.src_data)),
+                        getDramBytes(surface.src_data) + getDramBytes(surface.dst_data));
+  }
+  case DLA_OP_CDP: {
+    const dla_cdp_surface_desc& surface = operation.op_surf.cdp_surface;
+    return makeEstimate(NvDlaEngine::kCdp, getCyclesForElements(getNumOfElements(surface.src_data)),
+                        getDramBytes(surface.src_data) + getDramBytes(surface.dst_data));
+  }
+  case DLA_OP_RUBIK: {
+    const dla_rubik_surface_desc& surface = operation.op_surf.rubik_surface;
+    return makeEstimate(NvDlaEngine::kRubik, getCyclesForElements(getNumOfElements(surface.src_data)),
+                        getDramBytes(surface.src_data) + getDramBytes(surface.dst_data));
+  }
+  default:
+    break;
+  }
+
+  assert(false && "meet unknown operation type");
+  return Estimate{};
+}
+
+void NvDlaPerfModel::report(std::ostream& os, const std::vector<NvDlaDlaOperation*>& operations) const
+{
+  os << std::setw(6) << "index" << std::setw(8) << "engine" << std::setw(12) << "compute" << std::setw(12) << "memory"
+     << std::setw(12) << "cycles" << std::setw(12) << "DRAM bytes" << std::setw(11) << "occupancy" << "\n";
+
+  Estimate total;
+  for (std::size_t idx = 0; idx < operations.size(); ++idx) {
+    const Estimate result = estimate(*operations[idx]);
+    os << std::setw(6) << idx << std::setw(8) << NvDlaEngineModel::getName(result.engine) << std::setw(12)
+       << result.computeCycles << std::setw(12) << result.memoryCycles << std::setw(12) << result.cycles
+       << std::setw(12) << result.dramBytes << std::setw(10) << std::fixed << std::setprecision(1)
+       << result.getOccupancy() * 100 << "%\n";
+
+    total.computeCycles += result.computeCycles;
+    total.memoryCycles += result.memoryCycles;
+    total.cycles += result.cycles;
+    total.dramBytes += result.dramBytes;
+  }
+
+  // engines may overlap, so the total is an upper bound of the latency
+  os << std::setw(6) << "total" << std::setw(8) << "" << std::setw(12) << total.computeCycles << std::setw(12)
+     << total.memoryCycles << std::setw(12) << total.cycles << std::setw(12) << total.dramBytes << std::setw(10)
+     << std::fixed << std::setprecision(1) << total.getOccupancy() * 100 << "%\n";
+}
+
+NvDlaPerfModel::Estimate NvDlaPerfModel::makeEstimate(NvDlaEngine engine, Cycles computeCycles, Bytes dramBytes) const
+{
+  Estimate result;
+  result.engine        = engine;
+  result.computeCycles = computeCycles;
+  result.memoryCycles  = static_cast<Cycles>(std::ceil(dramBytes / m_DramBytesPerCycle));
+  result.cycles        = std::max(result.computeCycles, result.memoryCycles);
+  result.dramBytes     = dramBytes;
+  return result;
+}
+
+NvDlaPerfModel::Cycles NvDlaPerfModel::getCyclesForElements(Bytes numElements) const
+{
+  return DIV_ROUNDUP(numElements, static_cast<Bytes>(FEATURE_ATOM_CUBE_SIZE / ELEMENT_SIZE));
+}
+
+NvDlaPerfModel::Bytes NvDlaPerfModel::getNumOfWeightFetches(Bytes inputBytes, Bytes weightBytes, unsigned dataBanks,
+                                                            unsigned weightBanks) const
+{
+  const Bytes bankBytes = static_cast<Bytes>(CBUF_BANK_WIDTH) * CBUF_BANK_DEPTH;
+  if (weightBytes <= weightBanks * bankBytes || dataBanks == 0) {
+    return 1;
+  }
+
+  return std::max<Bytes>(DIV_ROUNDUP(inputBytes, dataBanks * bankBytes), 1);
+}
+
+} // namespace foonvdla
+} // namespace onnc
@@ -0,0 +1,85 @@
+//===- NvDlaPerfModel.h ---------------------------------------------------===//
+//
+//                             The ONNC Project
+//
+// See LICENSE.TXT for details.
+//
+//===----------------------------------------------------------------------===//
+#ifndef TARGET_FOONVDLA_NVDLA_PERF_MODEL_H
+#define TARGET_FOONVDLA_NVDLA_PERF_MODEL_H
+
+#include "NvDlaDefine.h"
+#include "NvDlaEngine.h"
+#include "NvDlaMeta.h"
+
+#include <onnc/IR/ComputeOperator.h>
+
+#include <cstdint>
+#include <ostream>
+#include <vector>
+
+namespace onnc {
+namespace foonvdla {
+
+struct NvDlaPerfEstimate
+{
+  using Cycles = std::uint64_t;
+  using Bytes  = std::uint64_t;
+
+  NvDlaEngine engine        = NvDlaEngine::kNone;
+  Cycles      computeCycles = 0; // the engine datapath is busy
+  Cycles      memoryCycles  = 0; // DRAM traffic at the configured bandwidth
+  Cycles      cycles        = 0; // computation and DMA overlap, so the larger of the two
+  Bytes       dramBytes     = 0;
+
+  /// Fraction of @ref cycles the datapath is busy, < 1 means memory bound.
+  double getOccupancy() const { return cycles == 0 ? 0.0 : static_cast<double>(computeCycles) / cycles; }
+};
+
+/** \class NvDlaPerfModel
+ *  \brief Analytical latency model of NVDLA operations.
+ *
+ *  Every engine consumes one ATOM per cycle, and CONV computes
+ *  MAC_ATOMIC_C x MAC_ATOMIC_K MACs per cycle. DRAM traffic is counted by
+ *  NvDlaCubeInfo sizes; weights which do not fit in CBUF next to the input
+ *  are fetched again for every input split. Cubes in CV-SRAM or passed on the
+ *  fly between engines are free.
+ *
+ *  Operators can be estimated before code emitting (for scheduling and fusion
+ *  decisions), and emitted operations from their descriptors.
+ */
+class NvDlaPerfModel : private NvDlaConstants
+{
+public:
+  using Cycles   = NvDlaPerfEstimate::Cycles;
+  using Bytes    = NvDlaPerfEstimate::Bytes;
+  using Estimate = NvDlaPerfEstimate;
+
+public:
+  NvDlaPerfModel(const NvDlaConstants& constants, double dramBytesPerCycle) noexcept;
+
+  Estimate estimate(const ComputeOperator& op) const;
+
+  Estimate estimate(const NvDlaDlaOperation& operation) const;
+
+  /// Print one line per operation and the total, in issuing order.
+  void report(std::ostream& os, const std::vector<NvDlaDlaOperation*>& operations) const;
+
+  double getDramBytesPerCycle() const noexcept { return m_DramBytesPerCycle; }
+
+private:
+  Estimate makeEstimate(NvDlaEngine engine, Cycles computeCycles, Bytes dramBytes) const;
+
+  Cycles getCyclesForElements(Bytes numElements) const;
+
+  /// # of times weights are read if the input is split to fit in CBUF.
+  Bytes getNumOfWeightFetches(Bytes inputBytes, Bytes weightBytes, unsigned dataBanks, unsigned weightBanks) const;
+
+private:
+  double m_DramBytesPerCycle;
+};
+
+} // namespace foonvdla
+} // namespace onnc
+
+#endif
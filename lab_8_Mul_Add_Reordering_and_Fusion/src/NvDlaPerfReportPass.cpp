@@ -0,0 +1,35 @@
+//===- NvDlaPerfReportPass.cpp --------------------------------------------===//
+//
+//                             The ONNC Project
+//
+// See LICENSE.TXT for details.
+//
+//===----------------------------------------------------------------------===//
+#include "NvDlaPerfReportPass.h"
+
+#include <onnc/Core/PassSupport.h>
+
+#include <iostream>
+
+namespace onnc {
+namespace foonvdla {
+
+//===----------------------------------------------------------------------===//
+// NvDlaPerfReportPass
+//===----------------------------------------------------------------------===//
+NvDlaPerfReportPass::NvDlaPerfReportPass(NvDlaBackendMeta* pMeta, const NvDlaPerfModel& perfModel) noexcept
+  : m_pMeta{pMeta}
+  , m_PerfModel{perfModel}
+{}
+
+Pass::ReturnType NvDlaPerfReportPass::runOnModule(Module& pModule)
+{
+  std::cout << "NvDlaPerfReportPass: " << m_pMeta->m_DLAOperationList.size() << " DLA operations, "
+            << m_PerfModel.getDramBytesPerCycle() << " DRAM bytes per cycle\n";
+  m_PerfModel.report(std::cout, m_pMeta->m_DLAOperationList);
+
+  return Pass::kModuleNoChanged;
+}
+
+} // namespace foonvdla
+} // namespace onnc
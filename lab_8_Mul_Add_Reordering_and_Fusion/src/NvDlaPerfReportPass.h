@@ -0,0 +1,36 @@
+//===- NvDlaPerfReportPass.h ----------------------------------------------===//
+//
+//                             The ONNC Project
+//
+// See LICENSE.TXT for details.
+//
+//===----------------------------------------------------------------------===//
+#ifndef ONNC_FOONVDLA_PERF_REPORT_PASS_H
+#define ONNC_FOONVDLA_PERF_REPORT_PASS_H
+#include "NvDlaMeta.h"
+#include "NvDlaPerfModel.h"
+
+#include <onnc/Core/CustomPass.h>
+
+namespace onnc {
+namespace foonvdla {
+
+/** \class NvDlaPerfReportPass
+ *  \brief Print the estimated cycles, DRAM bytes and occupancy of every emitted DLA operation.
+ */
+class NvDlaPerfReportPass : public CustomPass<NvDlaPerfReportPass>
+{
+public:
+  NvDlaPerfReportPass(NvDlaBackendMeta* pMeta, const NvDlaPerfModel& perfModel) noexcept;
+
+  ReturnType runOnModule(Module& pModule) override;
+
+private:
+  NvDlaBackendMeta*     m_pMeta;
+  const NvDlaPerfModel& m_PerfModel;
+};
+
+} // namespace foonvdla
+} // namespace onnc
+
+#endif
@@ -0,0 +1,39 @@
+//===- NvDlaPermutation.cpp -----------------------------------------------===//
+//
+//                             The ONNC Project
+//
+// See LICENSE.TXT for details.
+//
+//===----------------------------------------------------------------------===//
+#include "NvDlaPermutation.h"
+
+namespace onnc {
+namespace foonvdla {
+
+//===----------------------------------------------------------------------===//
+// NvDlaPermutation
+//===----------------------------------------------------------------------===//
+NvDlaPermutation::Axes NvDlaPermutation::get(const Transpose& transpose)
+{
+  const std::size_t rank = transpose.getInput(0)->getNumOfDimensions();
+  Axes              perm = transpose.getPerm().vector();
+  if (perm.empty()) {
+    for (std::size_t axis = rank; axis > 0; --axis) {
+      perm.emplace_back(axis - 1);
+    }
+  }
+  return perm;
+}
+
+bool NvDlaPermutation::isIdentity(const Axes& perm)
+{
+  for (std::size_t axis = 0; axis < perm.size(); ++axis) {
+    if (perm[axis] != static_cast<std::int64_t>(axis)) {
+      return false;
+    }
+  }
+  return true;
+}
+
+} // namespace foonvdla
+} // namespace onnc
@@ -0,0 +1,38 @@
+//===- NvDlaPermutation.h -------------------------------------------------===//
+//
+//                             The ONNC Project
+//
+// See LICENSE.TXT for details.
+//
+//===----------------------------------------------------------------------===//
+#ifndef TARGET_FOONVDLA_NVDLA_PERMUTATION_H
+#define TARGET_FOONVDLA_NVDLA_PERMUTATION_H
+
+#include <onnc/IR/Compute/Transpose.h>
+
+#include <cstdint>
+#include <vector>
+
+namespace onnc {
+namespace foonvdla {
+
+/** \class NvDlaPermutation
+ *  \brief The axis order of a Transpose, shared by the passes which fold or
+ *  rewrite it.
+ */
+class NvDlaPermutation
+{
+public:
+  using Axes = std::vector<std::int64_t>;
+
+public:
+  /// The input axis of each output axis. An empty perm reverses the axes.
+  static Axes get(const Transpose& transpose);
+
+  static bool isIdentity(const Axes& perm);
+};
+
+} // namespace foonvdla
+} // namespace onnc
+
+#endif
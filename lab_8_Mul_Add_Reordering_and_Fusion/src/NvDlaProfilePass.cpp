@@ -0,0 +1,62 @@
+//===- NvDlaProfilePass.cpp -----------------------------------------------===//
+//
+//                             The ONNC Project
+//
+// See LICENSE.TXT for details.
+//
+//===----------------------------------------------------------------------===//
+#include "NvDlaProfilePass.h"
+
+#include <onnc/Core/PassSupport.h>
+
+#include <fstream>
+#include <iostream>
+#include <utility>
+
+namespace onnc {
+namespace foonvdla {
+
+//===----------------------------------------------------------------------===//
+// NvDlaProfilePass
+//===----------------------------------------------------------------------===//
+NvDlaProfilePass::NvDlaProfilePass(NvDlaPassProfiler& profiler, std::string passName)
+  : m_Profiler{profiler}
+  , m_PassName{std::move(passName)}
+{}
+
+Pass::ReturnType NvDlaProfilePass::runOnModule(Module& pModule)
+{
+  m_Profiler.checkpoint(m_PassName, pModule);
+  return Pass::kModuleNoChanged;
+}
+
+//===----------------------------------------------------------------------===//
+// NvDlaProfileReportPass
+//===----------------------------------------------------------------------===//
+NvDlaProfileReportPass::NvDlaProfileReportPass(const NvDlaPassProfiler& profiler, std::string jsonFile)
+  : m_Profiler{profiler}
+  , m_JsonFile{std::move(jsonFile)}
+{}
+
+Pass::ReturnType NvDlaProfileReportPass::runOnModule(Module& pModule)
+{
+  std::cout << "NvDlaProfileReportPass: " << m_Profiler.getProfiles().size() << " passes profiled\n";
+  m_Profiler.report(std::cout);
+
+  if (m_JsonFile.empty()) {
+    return Pass::kModuleNoChanged;
+  }
+
+  std::ofstream file(m_JsonFile);
+  if (!file) {
+    std::cerr << "NvDlaProfileReportPass: cannot write " << m_JsonFile << "\n";
+    return Pass::kModuleNoChanged;
+  }
+  m_Profiler.writeJson(file);
+  std::cout << "NvDlaProfileReportPass: wrote " << m_JsonFile << "\n";
+
+  return Pass::kModuleNoChanged;
+}
+
+} // namespace foonvdla
+} // namespace onnc
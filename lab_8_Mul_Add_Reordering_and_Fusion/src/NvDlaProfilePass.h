@@ -0,0 +1,53 @@
+//===- NvDlaProfilePass.h -------------------------------------------------===//
+//
+//                             The ONNC Project
+//
+// See LICENSE.TXT for details.
+//
+//===----------------------------------------------------------------------===//
+#ifndef ONNC_FOONVDLA_PROFILE_PASS_H
+#define ONNC_FOONVDLA_PROFILE_PASS_H
+#include "NvDlaPassProfiler.h"
+
+#include <onnc/Core/CustomPass.h>
+
+#include <string>
+
+namespace onnc {
+namespace foonvdla {
+
+/** \class NvDlaProfilePass
+ *  \brief Checkpoint of NvDlaPassProfiler, added right after the profiled pass.
+ */
+class NvDlaProfilePass : public CustomPass<NvDlaProfilePass>
+{
+public:
+  NvDlaProfilePass(NvDlaPassProfiler& profiler, std::string passName);
+
+  ReturnType runOnModule(Module& pModule) override;
+
+private:
+  NvDlaPassProfiler& m_Profiler;
+  std::string        m_PassName;
+};
+
+/** \class NvDlaProfileReportPass
+ *  \brief Print the NvDlaPassProfiler table and write its JSON report, if a
+ *  file is given.
+ */
+class NvDlaProfileReportPass : public CustomPass<NvDlaProfileReportPass>
+{
+public:
+  NvDlaProfileReportPass(const NvDlaPassProfiler& profiler, std::string jsonFile);
+
+  ReturnType runOnModule(Module& pModule) override;
+
+private:
+  const NvDlaPassProfiler& m_Profiler;
+  std::string              m_JsonFile;
+};
+
+} // namespace foonvdla
+} // namespace onnc
+
+#endif
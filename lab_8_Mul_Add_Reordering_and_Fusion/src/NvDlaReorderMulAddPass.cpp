@@ -7,278 +7,422 @@
 //===----------------------------------------------------------------------===//
 #include "NvDlaReorderMulAddPass.h"
 
+#include "NvDlaBroadcast.h"
+#include "NvDlaRewriteDriver.h"
+#include "NvDlaUtil.h"
+
 #include <onnc/Core/PassSupport.h>
-#include <onnc/IR/Compute/Attributes.h>
+#include <onnc/IR/Compute/Add.h>
+#include <onnc/IR/Compute/Div.h>
 #include <onnc/IR/Compute/Initializer.h>
 #include <onnc/IR/Compute/Mul.h>
-#include <onnc/IR/Compute/Add.h>
+#include <onnc/IR/Compute/OutputOperator.h>
+#include <onnc/IR/Compute/Sub.h>
 #include <onnc/IR/ComputeOperator.h>
-#include <onnc/Transforms/Optimizations/OptimizationsUtils.h>
 
-using namespace onnc;
-using namespace onnc::foonvdla;
+#include <algorithm>
+#include <cassert>
+#include <iostream>
+#include <string>
+#include <vector>
+
+namespace onnc {
+namespace foonvdla {
+
+namespace internal {
+
+/// One operator of an affine chain, y = x + k, x - k, k - x, x * k or x / k.
+struct AffineStep
+{
+  enum Kind : unsigned
+  {
+    kAdd,
+    kSub,
+    kSubFrom,
+    kMul,
+    kDiv
+  };
+
+  ComputeOperator* op;
+  Kind             kind;
+  Tensor*          input;    // the non-constant operand
+  FloatTensor*     constant; // k
+
+  /// k - x both adds and scales.
+  bool isAdditive() const { return kind == kAdd || kind == kSub || kind == kSubFrom; }
+
+  bool isScaling() const { return kind == kMul || kind == kDiv || kind == kSubFrom; }
+};
+
+bool hasOutputOperatorUser(const Tensor& tensor)
+{
+  for (const auto& use : tensor.getUses()) {
+    if (isa<OutputOperator>(use.getUser())) {
+      return true;
+    }
+  }
+  return false;
+}
+
+/// The composition (x + offset) * scale of the steps so far, broadcast to dims.
+struct AffineForm
+{
+  NvDlaBroadcast::Dimensions dims;
+  std::vector<float>         offset{0.0f};
+  std::vector<float>         scale{1.0f};
+
+  /// Append @ref step, false if it can not be composed. The form is unchanged then.
+  bool compose(const AffineStep& step);
+
+  bool hasOffset() const
+  {
+    return std::any_of(offset.begin(), offset.end(), [](float value) { return value != 0.0f; });
+  }
+
+  bool hasScale() const
+  {
+    return std::any_of(scale.begin(), scale.end(), [](float value) { return value != 1.0f; });
+  }
+};
+
+bool AffineForm::compose(const AffineStep& step)
+{
+  NvDlaBroadcast::Dimensions newDims;
+  if (!NvDlaBroadcast::getDimensions(dims, step.constant->getDimensions(), newDims)) {
+    return false;
+  }
+
+  std::vector<float>       newOffset = NvDlaBroadcast::expand(offset, dims, newDims);
+  std::vector<float>       newScale  = NvDlaBroadcast::expand(scale, dims, newDims);
+  const std::vector<float> constant =
+    NvDlaBroadcast::expand(step.constant->getValues(), step.constant->getDimensions(), newDims);
+
+  for (std::size_t i = 0; i < constant.size(); ++i) {
+    float& c = newOffset[i];
+    float& a = newScale[i];
+    float  k = constant[i];
+    switch (step.kind) {
+    case AffineStep::kSub:
+      k = -k;
+      // fall through
+    case AffineStep::kAdd:
+    case AffineStep::kSubFrom:
+      // (x + c) * a + k = (x + c + k / a) * a, and k - (x + c) * a = (x + c - k / a) * -a
+      if (a == 0.0f) {
+        if (k != 0.0f) {
+          return false;
+        }
+      } else {
+        c += (step.kind == AffineStep::kSubFrom ? -k : k) / a;
+      }
+      if (step.kind == AffineStep::kSubFrom) {
+        a = -a;
+      }
+      break;
+    case AffineStep::kMul:
+      a *= k;
+      break;
+    case AffineStep::kDiv:
+      if (k == 0.0f) {
+        return false;
+      }
+      a /= k;
+      break;
+    }
+  }
+
+  dims.swap(newDims);
+  offset.swap(newOffset);
+  scale.swap(newScale);
+  return true;
+}
+
+/// The constant float operand of @ref op at @ref idx with all its values, or nullptr.
+FloatTensor* getAffineConstant(const ComputeOperator& op, unsigned idx)
+{
+  FloatTensor* constant = dynamic_cast<FloatTensor*>(op.getInput(idx));
+  if (constant == nullptr || !isConstant(*constant) ||
+      constant->getValues().size() != NvDlaBroadcast::getNumOfElements(constant->getDimensions())) {
+    return nullptr;
+  }
+  return constant;
+}
+
+bool getAffineStep(const ComputeOperator& op, AffineStep& step)
+{
+  if (op.getNumOfInputs() != 2 || op.getNumOfOutputs() != 1) {
+    return false;
+  }
+
+  FloatTensor* lhs = getAffineConstant(op, 0);
+  FloatTensor* rhs = getAffineConstant(op, 1);
+  if ((lhs == nullptr) == (rhs == nullptr)) {
+    return false;
+  }
+
+  step.op       = const_cast<ComputeOperator*>(&op);
+  step.input    = op.getInput(lhs == nullptr ? 0 : 1);
+  step.constant = (lhs == nullptr ? rhs : lhs);
+  if (isa<Add>(&op)) {
+    step.kind = AffineStep::kAdd;
+  } else if (isa<Sub>(&op)) {
+    step.kind = (lhs == nullptr ? AffineStep::kSub : AffineStep::kSubFrom);
+  } else if (isa<Mul>(&op)) {
+    step.kind = AffineStep::kMul;
+  } else if (isa<Div>(&op) && lhs == nullptr) {
+    step.kind = AffineStep::kDiv;
+  } else {
+    return false;
+  }
+  return true;
+}
+
+/// The longest chain from @ref head whose intermediate results are only read
+/// by the next step, composed into @ref form.
+std::vector<AffineStep> getAffineChain(const ComputeOperator& head, AffineForm& form)
+{
+  std::vector<AffineStep> chain;
+  AffineStep              step;
+  const ComputeOperator*  op = &head;
+  while (getAffineStep(*op, step) && (chain.empty() || step.input == chain.back().op->getOutput(0)) &&
+         form.compose(step)) {
+    chain.emplace_back(step);
+
+    const Value* output = op->getOutput(0);
+    if (output->getUses().size() != 1) {
+      break;
+    }
+    op = output->getUses()[0].getUser();
+  }
+  return chain;
+}
+
+/// Add, Mul and Add-Mul are already in the form (x + c) * a.
+bool isCanonical(const std::vector<AffineStep>& chain)
+{
+  switch (chain.size()) {
+  case 1:
+    return chain[0].kind == AffineStep::kAdd || chain[0].kind == AffineStep::kMul;
+  case 2:
+    return chain[0].kind == AffineStep::kAdd && chain[1].kind == AffineStep::kMul;
+  default:
+    break;
+  }
+  return false;
+}
+
+bool isChainHead(const ComputeOperator& op)
+{
+  AffineStep step;
+  if (!getAffineStep(op, step)) {
+    return false;
+  }
+
+  // a step right after a single-use step belongs to the chain of the latter
+  const ComputeOperator* producer = static_cast<ComputeOperator*>(step.input->getDefine());
+  AffineStep             previous;
+  if (producer != nullptr && getAffineStep(*producer, previous) && step.input->getUses().size() == 1) {
+    return false;
+  }
+
+  AffineForm form;
+  return !isCanonical(getAffineChain(op, form));
+}
+
+} // namespace internal
 
 //===----------------------------------------------------------------------===//
 // NvDlaReorderMulAddPass
 //===----------------------------------------------------------------------===//
-
 unsigned NvDlaReorderMulAddPass::tensorIdx = 0;
 
+NvDlaReorderMulAddPass::NvDlaReorderMulAddPass()
+  : m_Patterns{NvDlaPattern("AffineAdd").op<Add>().where(internal::isChainHead),
+               NvDlaPattern("AffineSub").op<Sub>().where(internal::isChainHead),
+               NvDlaPattern("AffineMul").op<Mul>().where(internal::isChainHead),
+               NvDlaPattern("AffineDiv").op<Div>().where(internal::isChainHead)}
+{
+  // The rest of a chain is found from its head, and the result is canonical,
+  // so it is not matched again.
+}
+
 Pass::ReturnType NvDlaReorderMulAddPass::runOnModule(Module& pModule)
 {
   std::cout << "NvDlaReorderMulAddPass is called...\n";
-  
-  const Pass::ReturnType ret = BaseType::runOnModule(pModule);
-
-  if (ret != kModuleNoChanged) {
-    pModule.eraseUnusedValues();
-  }
 
-  return ret;
+  return BaseType::runOnModule(pModule);
 }
 
 Pass::ReturnType NvDlaReorderMulAddPass::runOnComputeGraph(ComputeGraph& pCG)
 {
   Pass::ReturnType ret = Pass::kModuleNoChanged;
 
-  //--------------------------------------------------------
-  // Search for the Mul-Add patterns that can be reordered.
-  //--------------------------------------------------------
-  std::vector<ComputeOperator*> mulList;
-  for (ComputeOperator& node : pCG) {
-    if (canBeReordered(&node)) {
-      mulList.emplace_back(&node);
-      ret |= Pass::kModuleChanged;
-    }
+  //--------------------------------------------------------------------
+  // Canonicalize the affine chains. Each rewrite leaves at most one Add
+  // and one Mul, which match no pattern, so it ends within a finite # of
+  // steps.
+  //--------------------------------------------------------------------
+  NvDlaRewriteDriver driver(pCG);
+  for (const NvDlaPattern& pattern : m_Patterns) {
+    driver.add(pattern, [this](const NvDlaPatternMatch& match, NvDlaRewriteDriver& rewriter) {
+      reorder(match, rewriter);
+    });
+  }
+
+  const unsigned numOfChains = driver.run();
+  if (numOfChains != 0) {
+    std::cout << "NvDlaReorderMulAddPass: canonicalized " << numOfChains << " affine chains\n";
+    ret |= Pass::kModuleChanged;
   }
 
-  //--------------------------------------------
-  // Perform re-ordering on the found patterns.
-  //--------------------------------------------
-  // The original pattern is:
-  //   outputY = (inputX * alpha) + beta
+  return ret;
+}
+
+void NvDlaReorderMulAddPass::reorder(const NvDlaPatternMatch& match, NvDlaRewriteDriver& driver)
+{
+  // The original pattern is a chain of constant operations, e.g.:
+  //   outputY = ((inputX * alpha) + beta) / delta
   //
   // We will re-arrange the above pattern by:
-  //   outputY = (inputX + gamma) * alpha, where
-  //     gamma = beta / alpha
-
-  for (ComputeOperator* node : mulList) {
-    Mul* mul = dyn_cast<Mul>(node);
-    Add* add = dyn_cast<Add>(node->getOutput(0)->getUses()[0].getUser());
-
-    Tensor* inputX;
-    FloatTensor* alpha; // This kind of tensor contains constant values.
-    FloatTensor* beta;
-    Tensor* outputY;
-    Tensor* tmp;
-
-    // Find alpha and inputX. alpha must be a constant tensor.
-    // In this example, we assume that Mul must have one constant input.
-    if (isConstant(mul->getInput(0))) {
-      alpha = dynamic_cast<FloatTensor*>(mul->getInput(0));
-      inputX = mul->getInput(1);
-    } else {
-      inputX = mul->getInput(0);
-      alpha = dynamic_cast<FloatTensor*>(mul->getInput(1));
+  //   outputY = (inputX + gamma) * alpha', where
+  //     gamma  = beta / alpha
+  //     alpha' = alpha / delta
+  //
+  // Constants of different shapes are broadcast to each other first.
+  internal::AffineForm                    form;
+  const std::vector<internal::AffineStep> chain = internal::getAffineChain(*match.operators[0], form);
+  assert(!chain.empty() && "The chain head must be an affine step");
+
+  Tensor* inputX  = chain.front().input;
+  Tensor* outputY = chain.back().op->getOutput(0);
+
+  // An identity chain still needs an operator to define outputY.
+  const bool hasOffset = form.hasOffset();
+  const bool hasScale  = form.hasScale() || !hasOffset;
+
+  // Keep the names matching the operators: the new Add writes the result of
+  // the last additive step, tmp = inputX + gamma, and the new Mul the result
+  // of the last scaling step, which takes the place of outputY. A graph
+  // output keeps its name, so it stays the result of the Mul then.
+  Tensor* tmp    = nullptr;
+  Tensor* result = outputY;
+  if (hasOffset && hasScale) {
+    Tensor* added  = nullptr;
+    Tensor* scaled = nullptr;
+    for (const internal::AffineStep& step : chain) {
+      added  = (step.isAdditive() ? step.op->getOutput(0) : added);
+      scaled = (step.isScaling() ? step.op->getOutput(0) : scaled);
     }
-
-    // Find beta. beta must be a constant tensor.
-    // In this example, we assume that Add must have one constant input.
-    if (isConstant(add->getInput(0))) {
-      beta = dynamic_cast<FloatTensor*>(add->getInput(0));
-      tmp = add->getInput(1);
-    } else {
-      tmp = add->getInput(0);
-      beta = dynamic_cast<FloatTensor*>(add->getInput(1));
+    if (scaled != nullptr && scaled != added && !internal::hasOutputOperatorUser(*outputY)) {
+      result = scaled;
+      result->setDimensions(outputY->getDimensions());
     }
 
-    // Find outputY
-    outputY = add->getOutput(0);
-
-    std::string addOutputTensorName = add->getOutput(0)->getName();
-    std::string mulOutputTensorName = mul->getOutput(0)->getName();
-
-    // The current ONNC IR graph status
-    // ================================
-    //
-    //        (alphaInitializer)
-    //    |      |
-    // inputX  alpha
-    //      \   /
-    //      (mul)  (betaInitializer)
-    //        |      |
-    //       tmp   beta
-    //         \   /
-    //         (add)
-    //           |
-    //        outputY
-    //           |
-    //
-    
-    // Remove the edges between Mul/Add and their input/output tensors.
-    // We will re-build their edges later on.
-    // Remove an edge means to erase the records within an operator's data structure about its input tensors.
-    mul->removeAllInputs();
-    mul->removeAllOutputs();
-    add->removeAllInputs();
-    add->removeAllOutputs();
-
-    // The current ONNC IR graph status
-    // ================================
-    //
-    //        (alphaInitializer)
-    //    |      |
-    // inputX  alpha
-    //         
-    //      (mul)  (betaInitializer)
-    //              |
-    //       tmp   beta
-    //            
-    //         (add)
-    //           
-    //        outputY
-    //           |
-    //
-    
-    // Create a new tensor gamma.
-    FloatTensor* gamma = dynamic_cast<FloatTensor*>(beta->create());
-
-    // Give gamma tensor a unique name.
-    gamma->setName(beta->getName() + "__gamma_" + std::to_string(tensorIdx++) + ")");
-
-    // Initialize gamma.
-    gamma->setDimensions(beta->getDimensions());
-
-    // Add gamma into the ONNC IR graph.
-    gamma = pCG.addValue<FloatTensor>(gamma);
-    assert((gamma != nullptr) && "The name must be unique");
-    
-    // Create a new Initializer operator for gamma tensor. This is a must in ONNC IR graph.
-    // Every tensor must have a "defining" operator. For a constant tensor, its defining
-    // operator is an Initializer.
-    Initializer* gammaInitializer = pCG.addOperator<Initializer>();
-    gammaInitializer->setTensor(*gamma);
-
-    // The current ONNC IR graph status
-    // ================================
-    //
-    //        (alphaInitializer)
-    //    |      |
-    // inputX  alpha
-    //         
-    //      (mul)  (betaInitializer)
-    //              |
-    //       tmp   beta
-    //            
-    //         (add)     (gammaInitializer)
-    //                      |
-    //        outputY     gamma
-    //           |
-    //
-
-    // Get the constant data of beta.
-    const float* betaData = reinterpret_cast<const float*>(beta->getValues().data());
-
-    // Get the constant data of alpha.
-    const float* alphaData = reinterpret_cast<const float*>(alpha->getValues().data());
-
-    // Calculate the constant data of gamma.
-    int tensorSize = beta->getValues().size();
-    for (int i = 0; i < tensorSize; i++) {
-      gamma->getValues().push_back( betaData[i] / alphaData[i] );
+    if (added != nullptr && added != result) {
+      tmp = added;
+    } else {
+      tmp = dynamic_cast<Tensor*>(outputY->create());
+      tmp->setName(outputY->getName() + "__tmp_" + std::to_string(tensorIdx++));
+      tmp = driver.getGraph().addValue<Tensor>(tmp);
+      assert((tmp != nullptr) && "The name must be unique");
     }
 
-    // Remove beta from the ONNC IR graph. We don't need it anymore.
-    Initializer* betaInitializer = static_cast<Initializer*>(beta->getDefine());
-    pCG.erase(*betaInitializer);
-    pCG.erase(*beta);
-    
-    // The current ONNC IR graph status
-    // ================================
-    //
-    //        (alphaInitializer)
-    //    |      |
-    // inputX  alpha
-    //         
-    //      (mul)
-    //         
-    //       tmp
-    //            
-    //         (add)     (gammaInitializer)
-    //                      |
-    //        outputY     gamma
-    //           |
-    //
-
-    // Re-connect the operators.
-    add->addInput(*inputX);
-    add->addInput(*gamma);
-    add->addOutput(*tmp);
-    mul->addInput(*tmp);
-    mul->addInput(*alpha);
-    mul->addOutput(*outputY);
-
-    // The current ONNC IR graph status
-    // ================================
-    //
-    //        (gammaInitializer)
-    //    |      |
-    // inputX  gamma
-    //      \   /
-    //      (add)  (alphaInitializer)
-    //        |      |
-    //       tmp   alpha
-    //         \   /
-    //         (mul)
-    //           |
-    //        outputY
-    //           |
-    //
-
-    // Rename tensor tmp to become the original output tensor's name of add.
-    add->getOutput(0)->setName(addOutputTensorName);
-    // Rename tensor outputY to become the original output tensor's name of mul.
-    mul->getOutput(0)->setName(mulOutputTensorName);
+    NvDlaBroadcast::Dimensions dims;
+    NvDlaBroadcast::getDimensions(inputX->getDimensions(), form.dims, dims);
+    tmp->setDimensions(dims);
   }
 
-  pCG.topologicalSort();
-  
-  return ret;
-}
+  // Remove the chain. Its constants are erased if nothing else reads them.
+  const internal::AffineStep* additive = nullptr;
+  const internal::AffineStep* scaling  = nullptr;
+  unsigned                    numScaling = 0;
+  for (const internal::AffineStep& step : chain) {
+    if (step.isScaling()) {
+      scaling = &step;
+      ++numScaling;
+    }
+    if (step.isAdditive() && additive == nullptr) {
+      additive = &step;
+    }
 
-bool NvDlaReorderMulAddPass::canBeReordered(ComputeOperator* pNode)
-{
-  if (!isa<Mul>(pNode)) {
-    return false;
+    Tensor* output = step.op->getOutput(0);
+    step.op->removeAllInputs();
+    step.op->removeAllOutputs();
+    driver.erase(*step.op);
+    driver.collect(*step.constant);
+    if (output != outputY && output != tmp && output != result) {
+      driver.erase(*output);
+    }
   }
 
-  if (!isConstant(pNode->getInput(0)) && !isConstant(pNode->getInput(1))) {
-    return false;
+  // the consumers of the chain read its result under the new name
+  if (result != outputY) {
+    outputY->replaceAllUsesWith(*result);
+    if (outputY != tmp) {
+      driver.erase(*outputY);
+    }
   }
-  
-  Value* outv = pNode->getOutput(0);
 
-  // if Mul's result has more than one users, we can't fuse it.
-  if (outv->getUses().size() > 1) {
-    return false;
-  }
+  // Create a new constant tensor with its Initializer.
+  auto addConstant = [&driver, &form](FloatTensor& prototype, const std::string& name,
+                                      const std::vector<float>& values) {
+    FloatTensor* constant = dynamic_cast<FloatTensor*>(prototype.create());
+    constant->setName(name);
+    constant->setDimensions(form.dims);
+    constant = driver.getGraph().addValue<FloatTensor>(constant);
+    assert((constant != nullptr) && "The name must be unique");
+    constant->getValues() = values;
+
+    Initializer* initializer = driver.addOperator<Initializer>();
+    initializer->setTensor(*constant);
+    return constant;
+  };
+
+  // The current ONNC IR graph status
+  // ================================
+  //
+  //        (gammaInitializer)
+  //    |      |
+  // inputX  gamma
+  //      \   /
+  //      (add)  (alphaInitializer)
+  //        |      |
+  //       tmp   alpha'
+  //         \   /
+  //         (mul)
+  //           |
+  //         result
+  //           |
+  //
+  if (hasOffset) {
+    FloatTensor* gamma =
+      addConstant(*additive->constant, additive->constant->getName() + "__gamma_" + std::to_string(tensorIdx++),
+                  form.offset);
 
-  ComputeOperator* userNode = outv->getUses()[0].getUser();
-  if (!isa<Add>(userNode)) {
-    return false;
+    Add* add = driver.addOperator<Add>();
+    add->addInput(*inputX);
+    add->addInput(*gamma);
+    add->addOutput(hasScale ? *tmp : *result);
+    inputX = add->getOutput(0);
   }
 
-  return true;
-}
+  if (hasScale) {
+    // A single Mul constant of the same shape is reused as is.
+    FloatTensor* alpha = nullptr;
+    if (numScaling == 1 && scaling->kind == internal::AffineStep::kMul &&
+        scaling->constant->getDimensions() == form.dims) {
+      alpha = scaling->constant;
+    } else {
+      FloatTensor& prototype = *(scaling != nullptr ? scaling : &chain.front())->constant;
+      alpha = addConstant(prototype, prototype.getName() + "__alpha_" + std::to_string(tensorIdx++), form.scale);
+    }
 
-bool NvDlaReorderMulAddPass::isConstant(Value* pValue)
-{
-  // Only if this value's (tensor's) "defining" operator is Initializer,
-  // this tensor is a constant tensor.  
-  ComputeOperator* op = static_cast<ComputeOperator*>(pValue->getDefine());
-  if (isa<Initializer>(op)) {
-    return true;
-  } else {
-    return false;
+    Mul* mul = driver.addOperator<Mul>();
+    mul->addInput(*inputX);
+    mul->addInput(*alpha);
+    mul->addOutput(*result);
   }
 }
+
+} // namespace foonvdla
+} // namespace onnc
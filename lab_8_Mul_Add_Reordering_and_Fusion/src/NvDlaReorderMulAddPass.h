@@ -7,23 +7,39 @@
 //===----------------------------------------------------------------------===//
 #ifndef ONNC_FOONVDLA_REORDER_MUL_ADD_PASS_H
 #define ONNC_FOONVDLA_REORDER_MUL_ADD_PASS_H
+#include "NvDlaPattern.h"
+#include "NvDlaRewriteDriver.h"
+
 #include <onnc/Core/CustomPass.h>
 
+#include <vector>
+
 namespace onnc {
 namespace foonvdla {
 
+/** \class NvDlaReorderMulAddPass
+ *  \brief Canonicalize chains of constant Add, Sub, Mul and Div to (x + c) * a.
+ *
+ *  Each operator of a chain has one constant input, and its result is only
+ *  read by the next one. The constants are broadcast per layer, per channel or
+ *  per element, so the whole chain runs as one Add and one Mul, which are then
+ *  fused by NvDlaFuseAddMulReluPass. The form is (x + c) * a rather than
+ *  x * a + c, since an offset k after a scale a becomes k / a; a chain scaled
+ *  by zero is kept as is from the first offset which can not be moved.
+ */
 class NvDlaReorderMulAddPass : public CustomPass<NvDlaReorderMulAddPass>
 {
 public:
-  NvDlaReorderMulAddPass() = default;
+  NvDlaReorderMulAddPass();
 
   ReturnType runOnModule(Module& pModule) override;
 
   ReturnType runOnComputeGraph(ComputeGraph& pCG) override;
 
 private:
-  bool canBeReordered(ComputeOperator* pNode);
-  bool isConstant(Value* value);
+  void reorder(const NvDlaPatternMatch& match, NvDlaRewriteDriver& driver);
+
+  std::vector<NvDlaPattern> m_Patterns;
 
   static unsigned tensorIdx;
 };
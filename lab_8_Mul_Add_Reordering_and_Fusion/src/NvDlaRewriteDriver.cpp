@@ -0,0 +1,290 @@
+//===- NvDlaRewriteDriver.cpp ---------------------------------------------===//
+//
+//                             The ONNC Project
+//
+// See LICENSE.TXT for details.
+//
+//===----------------------------------------------------------------------===//
+#include "NvDlaRewriteDriver.h"
+
+#include <onnc/IR/Compute/Initializer.h>
+#include <onnc/Support/Casting.h>
+
+#include <algorithm>
+#include <limits>
+
+namespace onnc {
+namespace foonvdla {
+
+//===----------------------------------------------------------------------===//
+// NvDlaRewriteDriver
+//===----------------------------------------------------------------------===//
+NvDlaRewriteDriver::NvDlaRewriteDriver(ComputeGraph& pCG)
+  : m_Graph{pCG}
+  , m_NextId{0}
+{}
+
+NvDlaRewriteDriver& NvDlaRewriteDriver::add(NvDlaPattern pattern, Rewrite rewrite)
+{
+  m_Patterns.add(std::move(pattern));
+  m_Rewrites.emplace_back(std::move(rewrite));
+  return *this;
+}
+
+unsigned NvDlaRewriteDriver::run()
+{
+  if (m_Patterns.empty()) {
+    return 0;
+  }
+
+  // the graph is in a topological order before the first rewrite
+  Rank rank = 0;
+  for (ComputeOperator& op : m_Graph) {
+    m_Ranks[&op] = rank++;
+    enqueue(op);
+  }
+
+  unsigned numOfRewrites = 0;
+  while (!m_Worklist.empty()) {
+    ComputeOperator* op = m_Operators.at(m_Worklist.begin()->second);
+    m_Worklist.erase(m_Worklist.begin());
+
+    const NvDlaPatternSet::MatchList matches = m_Patterns.match(*op);
+    if (matches.empty()) {
+      continue;
+    }
+
+    apply(matches.front());
+    ++numOfRewrites;
+  }
+
+  // operators are appended to the graph, sort it once for the later passes
+  if (numOfRewrites != 0 && !isTopological()) {
+    m_Graph.topologicalSort();
+  }
+  return numOfRewrites;
+}
+
+void NvDlaRewriteDriver::erase(ComputeOperator& op) { m_ErasedOps.insert(&op); }
+
+void NvDlaRewriteDriver::erase(Value& value) { m_ErasedValues.insert(&value); }
+
+void NvDlaRewriteDriver::collect(Value& value) { m_Candidates.emplace_back(&value); }
+
+void NvDlaRewriteDriver::apply(const NvDlaPatternMatch& match)
+{
+  m_Created.clear();
+  m_ErasedOps.clear();
+  m_ErasedValues.clear();
+  m_Candidates.clear();
+
+  // values around the region, garbage if the rewrite leaves them unused
+  for (ComputeOperator* op : match.operators) {
+    dequeue(*op);
+    for (unsigned idx = 0; idx < op->getNumOfInputs(); ++idx) {
+      collect(*op->getInput(idx));
+    }
+    for (unsigned idx = 0; idx < op->getNumOfOutputs(); ++idx) {
+      collect(*op->getOutput(idx));
+    }
+  }
+
+  m_Rewrites[match.index](match, *this);
+
+  for (ComputeOperator* op : m_ErasedOps) {
+    forget(*op);
+    m_Graph.erase(*op);
+  }
+  for (Value* value : m_ErasedValues) {
+    m_Graph.erase(*value);
+  }
+  collectGarbage();
+
+  std::vector<ComputeOperator*> region;
+  for (ComputeOperator* op : match.operators) {
+    if (m_ErasedOps.count(op) == 0) {
+      region.emplace_back(op);
+    }
+  }
+  for (ComputeOperator* op : m_Created) {
+    if (m_ErasedOps.count(op) == 0) {
+      region.emplace_back(op);
+    }
+  }
+
+  place(region);
+  for (ComputeOperator* op : region) {
+    enqueue(*op);
+    enqueueProducers(*op, m_Patterns.getMaxNumOfNodes() - 1);
+    enqueueUsers(*op);
+  }
+}
+
+void NvDlaRewriteDriver::collectGarbage()
+{
+  std::unordered_set<Value*> visited;
+  for (Value* value : m_Candidates) {
+    if (!visited.insert(value).second || m_ErasedValues.count(value) != 0 || !value->getUses().empty()) {
+      continue;
+    }
+
+    // values of erased operators go with them, and so do unused constants
+    ComputeOperator* producer = static_cast<ComputeOperator*>(value->getDefine());
+    if (producer != nullptr && m_ErasedOps.count(producer) == 0) {
+      if (!isa<Initializer>(producer)) {
+        continue;
+      }
+
+      producer->removeAllOutputs();
+      forget(*producer);
+      m_Graph.erase(*producer);
+    }
+    m_Graph.erase(*value);
+  }
+}
+
+void NvDlaRewriteDriver::place(const std::vector<ComputeOperator*>& ops)
+{
+  // visit the region by a local topological order, so producers inside it are ranked first
+  std::unordered_set<const ComputeOperator*>           pending(ops.begin(), ops.end());
+  std::unordered_map<const ComputeOperator*, unsigned> numOfPendingInputs;
+  std::vector<ComputeOperator*>                        ready;
+  for (ComputeOperator* op : ops) {
+    unsigned& numOfInputs = numOfPendingInputs[op];
+    for (unsigned idx = 0; idx < op->getNumOfInputs(); ++idx) {
+      numOfInputs += pending.count(static_cast<ComputeOperator*>(op->getInput(idx)->getDefine()));
+    }
+    if (numOfInputs == 0) {
+      ready.emplace_back(op);
+    }
+  }
+
+  const Rank lowest  = std::numeric_limits<Rank>::lowest();
+  const Rank highest = std::numeric_limits<Rank>::max();
+  while (!ready.empty()) {
+    ComputeOperator* op = ready.back();
+    ready.pop_back();
+    pending.erase(op);
+
+    Rank lower = lowest;
+    for (unsigned idx = 0; idx < op->getNumOfInputs(); ++idx) {
+      const auto found = m_Ranks.find(static_cast<ComputeOperator*>(op->getInput(idx)->getDefine()));
+      if (found != m_Ranks.end()) {
+        lower = std::max(lower, found->second);
+      }
+    }
+
+    Rank upper = highest;
+    for (unsigned idx = 0; idx < op->getNumOfOutputs(); ++idx) {
+      for (const auto& use : op->getOutput(idx)->getUses()) {
+        ComputeOperator* user = use.getUser();
+        if (pending.count(user) != 0) {
+          if (--numOfPendingInputs[user] == 0) {
+            ready.emplace_back(user);
+          }
+          continue;
+        }
+
+        const auto found = m_Ranks.find(user);
+        if (found != m_Ranks.end()) {
+          upper = std::min(upper, found->second);
+        }
+      }
+    }
+
+    // without room between the producers and users, the ranks only approximate
+    // the order, which affects the visiting order but not the result
+    Rank rank = 0;
+    if (lower != lowest && upper != highest && lower < upper) {
+      rank = lower + (upper - lower) / 2;
+    } else if (lower != lowest) {
+      rank = lower + 1;
+    } else if (upper != highest) {
+      rank = upper - 1;
+    }
+    m_Ranks[op] = rank;
+  }
+}
+
+unsigned NvDlaRewriteDriver::getId(ComputeOperator& op)
+{
+  const auto found = m_Ids.find(&op);
+  if (found != m_Ids.end()) {
+    return found->second;
+  }
+
+  const unsigned id = m_NextId++;
+  m_Ids.emplace(&op, id);
+  m_Operators.emplace(id, &op);
+  return id;
+}
+
+void NvDlaRewriteDriver::forget(ComputeOperator& op)
+{
+  dequeue(op);
+  m_Ranks.erase(&op);
+
+  const auto found = m_Ids.find(&op);
+  if (found != m_Ids.end()) {
+    m_Operators.erase(found->second);
+    m_Ids.erase(found);
+  }
+}
+
+void NvDlaRewriteDriver::enqueue(ComputeOperator& op)
+{
+  const auto found = m_Ranks.find(&op);
+  if (found != m_Ranks.end()) {
+    m_Worklist.emplace(found->second, getId(op));
+  }
+}
+
+void NvDlaRewriteDriver::dequeue(ComputeOperator& op)
+{
+  const auto found = m_Ranks.find(&op);
+  if (found != m_Ranks.end()) {
+    m_Worklist.erase(std::make_pair(found->second, getId(op)));
+  }
+}
+
+void NvDlaRewriteDriver::enqueueProducers(ComputeOperator& op, unsigned depth)
+{
+  if (depth == 0) {
+    return;
+  }
+
+  for (unsigned idx = 0; idx < op.getNumOfInputs(); ++idx) {
+    ComputeOperator* producer = static_cast<ComputeOperator*>(op.getInput(idx)->getDefine());
+    if (producer != nullptr && m_Ranks.count(producer) != 0) {
+      enqueue(*producer);
+      enqueueProducers(*producer, depth - 1);
+    }
+  }
+}
+
+void NvDlaRewriteDriver::enqueueUsers(ComputeOperator& op)
+{
+  for (unsigned idx = 0; idx < op.getNumOfOutputs(); ++idx) {
+    for (const auto& use : op.getOutput(idx)->getUses()) {
+      enqueue(*use.getUser());
+    }
+  }
+}
+
+bool NvDlaRewriteDriver::isTopological() const
+{
+  std::unordered_set<const ComputeOperator*> visited;
+  for (ComputeOperator& op : m_Graph) {
+    for (unsigned idx = 0; idx < op.getNumOfInputs(); ++idx) {
+      const ComputeOperator* producer = static_cast<ComputeOperator*>(op.getInput(idx)->getDefine());
+      if (producer != nullptr && visited.count(producer) == 0) {
+        return false;
+      }
+    }
+    visited.insert(&op);
+  }
+  return true;
+}
+
+} // namespace foonvdla
+} // namespace onnc
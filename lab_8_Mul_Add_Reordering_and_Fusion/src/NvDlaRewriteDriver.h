@@ -0,0 +1,122 @@
+//===- NvDlaRewriteDriver.h -----------------------------------------------===//
+//
+//                             The ONNC Project
+//
+// See LICENSE.TXT for details.
+//
+//===----------------------------------------------------------------------===//
+#ifndef TARGET_FOONVDLA_NVDLA_REWRITE_DRIVER_H
+#define TARGET_FOONVDLA_NVDLA_REWRITE_DRIVER_H
+
+#include "NvDlaPattern.h"
+
+#include <onnc/IR/ComputeGraph.h>
+#include <onnc/IR/ComputeOperator.h>
+
+#include <functional>
+#include <set>
+#include <unordered_map>
+#include <unordered_set>
+#include <utility>
+#include <vector>
+
+namespace onnc {
+namespace foonvdla {
+
+/** \class NvDlaRewriteDriver
+ *  \brief Apply pattern rewrites on a graph until none of them matches.
+ *
+ *  Operators are visited from a worklist by their topological rank. After a
+ *  rewrite, only the rewritten region is ranked again, and the region, the
+ *  operators upstream of it (a larger pattern may be rooted there now) and
+ *  its users are put back to the worklist. Operators and values erased by a rewrite,
+ *  and constants left unused, are erased right after it, so neither a
+ *  topological sort nor Module::eraseUnusedValues() is needed per rewrite,
+ *  and a pass driving it needs no clean-up of its own after the rewrites.
+ *  The graph is sorted once at the fixpoint if appended operators broke its
+ *  order.
+ *
+ *  A rewrite creates operators by addOperator() and hands detached operators
+ *  and values to erase() instead of erasing them from the graph.
+ */
+class NvDlaRewriteDriver
+{
+public:
+  using Rewrite = std::function<void(const NvDlaPatternMatch& match, NvDlaRewriteDriver& driver)>;
+
+public:
+  explicit NvDlaRewriteDriver(ComputeGraph& pCG);
+
+  NvDlaRewriteDriver& add(NvDlaPattern pattern, Rewrite rewrite);
+
+  /// Rewrite to the fixpoint, and return the # of applied rewrites.
+  unsigned run();
+
+  ComputeGraph& getGraph() noexcept { return m_Graph; }
+
+  template <typename OpType, typename... ArgTypes>
+  OpType* addOperator(ArgTypes&&... args)
+  {
+    OpType* op = m_Graph.addOperator<OpType>(std::forward<ArgTypes>(args)...);
+    m_Created.emplace_back(op);
+    return op;
+  }
+
+  /// Erase a detached operator after the rewrite.
+  void erase(ComputeOperator& op);
+
+  /// Erase an unused value after the rewrite.
+  void erase(Value& value);
+
+  /// Erase @ref value after the rewrite if it is left unused, with the constant defining it.
+  void collect(Value& value);
+
+private:
+  using Rank = double;
+
+  void apply(const NvDlaPatternMatch& match);
+
+  /// Erase the unused values among the candidates, with the constants defining them.
+  void collectGarbage();
+
+  /// Rank @ref ops between their producers and users.
+  void place(const std::vector<ComputeOperator*>& ops);
+
+  unsigned getId(ComputeOperator& op);
+
+  /// Drop the bookkeeping of an operator which is going to be erased.
+  void forget(ComputeOperator& op);
+
+  void enqueue(ComputeOperator& op);
+
+  void dequeue(ComputeOperator& op);
+
+  /// Put the producers up to @ref depth levels above @ref op back to the worklist.
+  void enqueueProducers(ComputeOperator& op, unsigned depth);
+
+  void enqueueUsers(ComputeOperator& op);
+
+  bool isTopological() const;
+
+private:
+  ComputeGraph&        m_Graph;
+  NvDlaPatternSet      m_Patterns;
+  std::vector<Rewrite> m_Rewrites;
+
+  std::unordered_map<const ComputeOperator*, Rank>     m_Ranks;
+  std::unordered_map<const ComputeOperator*, unsigned> m_Ids; // break ties between equal ranks
+  std::unordered_map<unsigned, ComputeOperator*>       m_Operators;
+  std::set<std::pair<Rank, unsigned>>                  m_Worklist;
+  unsigned                                             m_NextId;
+
+  // created and erased by the running rewrite
+  std::vector<ComputeOperator*>        m_Created;
+  std::unordered_set<ComputeOperator*> m_ErasedOps;
+  std::unordered_set<Value*>           m_ErasedValues;
+  std::vector<Value*>                  m_Candidates;
+};
+
+} // namespace foonvdla
+} // namespace onnc
+
+#endif
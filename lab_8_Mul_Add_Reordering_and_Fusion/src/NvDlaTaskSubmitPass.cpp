@@ -0,0 +1,657 @@
+//===- NvDlaTaskSubmitPass.cpp --------------------------------------------===//
+//
+//                             The ONNC Project
+//
+// See LICENSE.TXT for details.
+//
+//===----------------------------------------------------------------------===//
+#include "NvDlaTaskSubmitPass.h"
+
+#include "NvDlaMeta.h"
+
+#include <onnc/IR/Compute/Initializer.h>
+#include <onnc/IR/Compute/InputOperator.h>
+#include <onnc/IR/Compute/OutputOperator.h>
+#include <onnc/IR/Compute/Tensor.h>
+#include <onnc/Support/Casting.h>
+#include <onnc/Support/IOStream.h>
+#include <onnc/Support/String.h>
+#include <onnc/Support/Timer.h>
+
+#include <unordered_map>
+#include <vector>
+
+using ::onnc::foonvdla::ILoadable;
+
+namespace onnc {
+namespace foonvdla {
+namespace internal {
+
+ILoadable::Version& assign(ILoadable::Version& destVersion, const Version& srcVersion)
+{
+  destVersion.major     = srcVersion.major;
+  destVersion.minor     = srcVersion.minor;
+  destVersion.sub_minor = srcVersion.subMinor;
+
+  return destVersion;
+}
+
+/// Fields of a surface descriptor which refer to the address list.
+std::vector<std::int16_t*> getAddresses(union dla_surface_container& surface, std::uint8_t opType)
+{
+  std::vector<std::int16_t*> addresses;
+  switch (opType) {
+  case DLA_OP_BDMA:
+    for (std::uint16_t idx = 0; idx < surface.bdma_surface.num_transfers; ++idx) {
+      addresses.push_back(&surface.bdma_surface.transfers[idx].source_address);
+      addresses.push_back(&surface.bdma_surface.transfers[idx].destination_address);
+    }
+    break;
+  case DLA_OP_CONV:
+    addresses = {&surface.conv_surface.weight_data.address, &surface.conv_surface.wmb_data.address,
+                 &surface.conv_surface.wgs_data.address, &surface.conv_surface.src_data.address,
+                 &surface.conv_surface.dst_data.address};
+    break;
+  case DLA_OP_SDP:
+    addresses = {&surface.sdp_surface.src_data.address, &surface.sdp_surface.x1_data.address,
+                 &surface.sdp_surface.x2_data.address, &surface.sdp_surface.y_data.address,
+                 &surface.sdp_surface.dst_data.address};
+    break;
+  case DLA_OP_PDP:
+    addresses = {&surface.pdp_surface.src_data.address, &surface.pdp_surface.dst_data.address};
+    break;
+  case DLA_OP_CDP:
+    addresses = {&surface.cdp_surface.src_data.address, &surface.cdp_surface.dst_data.address};
+    break;
+  case DLA_OP_RUBIK:
+    addresses = {&surface.rubik_surface.src_data.address, &surface.rubik_surface.dst_data.address};
+    break;
+  default:
+    assert(false && "meet unknown operation type");
+    break;
+  }
+  return addresses;
+}
+
+std::vector<NvS16*> getAddresses(union emu_operation_buffer_container& buffers, NvU8 opType)
+{
+  switch (opType) {
+  case NVDLA_EMU_OP_POWER:
+    return {&buffers.power_buffers.src_data.addressIndex, &buffers.power_buffers.dst_data.addressIndex};
+  case NVDLA_EMU_OP_SOFTMAX:
+    return {&buffers.softmax_buffers.src_data.addressIndex, &buffers.softmax_buffers.dst_data.addressIndex};
+  case NVDLA_EMU_OP_LOG:
+    return {&buffers.log_buffers.src_data.addressIndex, &buffers.log_buffers.dst_data.addressIndex};
+  default:
+    break;
+  }
+  assert(false && "meet unknown operation type");
+  return {};
+}
+
+} // namespace internal
+
+//===----------------------------------------------------------------------===//
+// NvDlaTaskSubmitPass
+//===----------------------------------------------------------------------===//
+NvDlaTaskSubmitPass::NvDlaTaskSubmitPass(NvDlaBackendMeta* pMeta, Version pDlaVersion, Version pEmuVersion,
+                                         bool pStreaming, unsigned pNumRois)
+  : m_pMeta(pMeta)
+  , m_DlaVersion(pDlaVersion)
+  , m_EmuVersion(pEmuVersion)
+  , m_Streaming(pStreaming)
+  , m_NumRois(pNumRois)
+{
+  assert(0 < m_NumRois);
+}
+
+Pass::ReturnType NvDlaTaskSubmitPass::runOnModule(Module& pModule)
+{
+  using namespace internal;
+
+  using OperationCategory = NvDlaBackendMeta::OperationMeta::Category;
+
+  if (1 < m_NumRois) {
+    prepareRois();
+  }
+
+  std::vector<TaskListEntryId> tasks;
+
+  unsigned taskIndex = 0;
+  for (std::size_t iTaskStart = 0; iTaskStart < m_pMeta->m_OperationMetas.size(); ++taskIndex) {
+    const OperationCategory category = m_pMeta->m_OperationMetas[iTaskStart].category;
+
+    // find last operation (in task) which has same category and core
+    std::size_t iTaskEnd = iTaskStart + 1;
+    for (; iTaskEnd < m_pMeta->m_OperationMetas.size(); ++iTaskEnd) {
+      if (NvDlaBackendMeta::isTaskBoundary(m_pMeta->m_OperationMetas[iTaskEnd - 1],
+                                           m_pMeta->m_OperationMetas[iTaskEnd])) {
+        break;
+      }
+    }
+    assert(iTaskEnd <= m_pMeta->m_OperationMetas.size());
+
+    const std::size_t numTasks = (iTaskEnd - iTaskStart);
+    // submit for different type tasks
+    if (category == OperationCategory::dla) {
+      int dla_start;
+      {
+        std::string blob_name = to_string("task-", taskIndex, "-addr0");
+
+        ILoadable::Blob b;
+        b.name         = blob_name;
+        b.size         = sizeof(struct dla_network_desc);
+        b.interface    = ILoadable::Interface_DLA1;
+        b.subInterface = 0;
+        assign(b.version, m_DlaVersion);
+
+        NvU8* blob_data = new NvU8[b.size];
+
+        m_pMeta->m_DlaNetworkDesc.operation_desc_index   = m_pMeta->m_AddressListEntries.size() + 2;
+        m_pMeta->m_DlaNetworkDesc.surface_desc_index     = m_pMeta->m_AddressListEntries.size() + 3;
+        m_pMeta->m_DlaNetworkDesc.dependency_graph_index = m_pMeta->m_AddressListEntries.size() + 1;
+        m_pMeta->m_DlaNetworkDesc.lut_data_index =
+          (m_pMeta->m_LUTList.empty() ? -1 : m_pMeta->m_AddressListEntries.size() + 4);
+        m_pMeta->m_DlaNetworkDesc.roi_array_index = -1;
+        m_pMeta->m_DlaNetworkDesc.surface_index   = -1;
+        m_pMeta->m_DlaNetworkDesc.stat_list_index = -1;
+        m_pMeta->m_DlaNetworkDesc.stat_list_index = -1;
+
+        m_pMeta->m_DlaNetworkDesc.num_rois       = m_NumRois;
+        m_pMeta->m_DlaNetworkDesc.num_operations = numTasks;
+        m_pMeta->m_DlaNetworkDesc.num_luts       = m_pMeta->m_NumLUTs;
+        m_pMeta->m_DlaNetworkDesc.num_addresses  = m_pMeta->m_AddressListEntries.size() + 5;
+
+        m_pMeta->m_DlaNetworkDesc.input_layer = 0;
+        m_pMeta->m_DlaNetworkDesc.dynamic_roi = 0;
+
+        memcpy(blob_data, &(m_pMeta->m_DlaNetworkDesc), sizeof(struct dla_network_desc));
+
+        m_pMeta->m_Loadable.priv()->setSymbolContent(blob_name, b, blob_data);
+        dla_start = submitMemAllocAddress(b.size, blob_name);
+      }
+
+      {
+        std::string     blob_name = to_string("task-", taskIndex, "-dep_graph");
+        ILoadable::Blob b;
+        b.name         = blob_name;
+        b.size         = m_NumRois * numTasks * sizeof(struct dla_common_op_desc);
+        b.interface    = ILoadable::Interface_DLA1;
+        b.subInterface = 0;
+        assign(b.version, m_DlaVersion);
+
+        // the firmware tracks the dependencies of ROI r at [r * num_operations]
+        NvU8*                      blob_data = new NvU8[b.size];
+        struct dla_common_op_desc* op_blob   = (struct dla_common_op_desc*)blob_data;
+        for (unsigned roi = 0; roi < m_NumRois; ++roi) {
+          for (std::size_t i = iTaskStart; i < iTaskEnd; i++) {
+            const auto& opMeta = m_pMeta->m_OperationMetas[i];
+
+            NvDlaDlaOperation*        op     = m_pMeta->m_DLAOperationList[opMeta.index];
+            struct dla_common_op_desc op_dep = op->op_dep;
+            op_dep.roi_index                 = roi;
+            memcpy(op_blob + roi * numTasks + (i - iTaskStart), &op_dep, sizeof(struct dla_common_op_desc));
+          }
+        }
+
+        m_pMeta->m_Loadable.priv()->setSymbolContent(blob_name, b, blob_data);
+        submitMemAllocAddress(b.size, blob_name);
+      }
+
+      {
+        std::string     blob_name = to_string("task-", taskIndex, "-op_list");
+        ILoadable::Blob b;
+        b.name         = blob_name;
+        b.size         = numTasks * sizeof(union dla_operation_container);
+        b.interface    = ILoadable::Interface_DLA1;
+        b.subInterface = 0;
+        assign(b.version, m_DlaVersion);
+
+        NvU8*                          blob_data = new NvU8[b.size];
+        union dla_operation_container* op_blob   = (union dla_operation_container*)blob_data;
+        for (std::size_t i = iTaskStart; i < iTaskEnd; i++) {
+          const auto& opMeta = m_pMeta->m_OperationMetas[i];
+
+          NvDlaDlaOperation* op = m_pMeta->m_DLAOperationList[opMeta.index];
+          memcpy(op_blob + (i - iTaskStart), &(op->op_desc), sizeof(union dla_operation_container));
+        }
+
+        m_pMeta->m_Loadable.priv()->setSymbolContent(blob_name, b, blob_data);
+        submitMemAllocAddress(b.size, blob_name);
+      }
+
+      {
+        std::string     blob_name = to_string("task-", taskIndex, "-surf_list");
+        ILoadable::Blob b;
+        b.name         = blob_name;
+        b.size         = m_NumRois * numTasks * sizeof(union dla_surface_container);
+        b.interface    = ILoadable::Interface_DLA1;
+        b.subInterface = 0;
+        assign(b.version, m_DlaVersion);
+
+        // the firmware picks the surfaces of ROI r at [r * num_operations], operations are shared
+        NvU8*                        blob_data = new NvU8[b.size];
+        union dla_surface_container* op_blob   = (union dla_surface_container*)blob_data;
+        for (unsigned roi = 0; roi < m_NumRois; ++roi) {
+          for (std::size_t i = iTaskStart; i < iTaskEnd; i++) {
+            const auto& opMeta = m_pMeta->m_OperationMetas[i];
+
+            NvDlaDlaOperation*          op      = m_pMeta->m_DLAOperationList[opMeta.index];
+            union dla_surface_container surface = op->op_surf;
+            // ROI 0 keeps the addresses of the emitted operation
+            if (0 < roi) {
+              for (std::int16_t* address : getAddresses(surface, op->op_dep.op_type)) {
+                *address = getRoiAddress(*address, roi);
+              }
+            }
+            memcpy(op_blob + roi * numTasks + (i - iTaskStart), &surface, sizeof(union dla_surface_container));
+          }
+        }
+
+        m_pMeta->m_Loadable.priv()->setSymbolContent(blob_name, b, blob_data);
+        submitMemAllocAddress(b.size, blob_name);
+      }
+
+      if (!m_pMeta->m_LUTList.empty()) {
+        std::string     blob_name = to_string("task-", taskIndex, "-lut_list");
+        ILoadable::Blob b;
+        b.name         = blob_name;
+        b.size         = m_pMeta->m_LUTList.size() * sizeof(struct dla_lut_param);
+        b.interface    = ILoadable::Interface_DLA1;
+        b.subInterface = 0;
+        assign(b.version, m_DlaVersion);
+
+        NvU8*                 blob_data = new NvU8[b.size];
+        struct dla_lut_param* op_blob   = (struct dla_lut_param*)blob_data;
+        for (int i = 0; i < m_pMeta->m_LUTList.size(); i++) {
+          struct dla_lut_param* lut = m_pMeta->m_LUTList[i];
+          memcpy(op_blob + i, lut, sizeof(struct dla_lut_param));
+        }
+
+        m_pMeta->m_Loadable.priv()->setSymbolContent(blob_name, b, blob_data);
+        submitMemAllocAddress(b.size, blob_name);
+      }
+
+      {
+        ILoadable::MemoryListEntry mle;
+        mle.id             = m_pMeta->m_MemoryListEntries.size();
+        mle.alignment      = 4096;
+        mle.bind_id        = 0;
+        mle.domain         = ILoadable::MemoryDomain_SYSMEM;
+        mle.flags          = ILoadable::MemoryFlags_ALLOC;
+        mle.size           = 4096;
+        mle.tensor_desc_id = 0;
+        m_pMeta->m_MemoryListEntries.push_back(mle);
+
+        ILoadable::AddressListEntry ale;
+        ale.size   = 0;
+        ale.offset = 0;
+        ale.mem_id = mle.id;
+        ale.id     = m_pMeta->m_AddressListEntries.size();
+        m_pMeta->m_AddressListEntries.push_back(ale);
+      }
+
+      {
+        ILoadable::TaskListEntry tle;
+
+        tle.id        = m_pMeta->m_TaskListEntries.size();
+        tle.interface = ILoadable::Interface_DLA1;
+        // tasks of a partitioned graph are pinned to their NVDLA instance, and
+        // the wait/signal events below are the synchronization points between them
+        tle.instance = (m_pMeta->m_OperatorCores.empty() ? -1 : m_pMeta->m_OperationMetas[iTaskStart].core);
+
+        if (0 < taskIndex) {
+          tle.preactions.push_back(submitEvent(tle.id, NVDLA_LOADABLE_EVENT_OP_WAIT));
+          tle.postactions.push_back(submitEvent(tle.id, NVDLA_LOADABLE_EVENT_OP_SIGNAL));
+        } else {
+          tle.preactions.push_back(submitEvent(tle.id, NVDLA_LOADABLE_EVENT_OP_SIGNAL));
+        }
+
+        tle.address_list.push_back(dla_start);
+        for (int i = 1; i < m_pMeta->m_AddressListEntries.size(); i++)
+          tle.address_list.push_back(i);
+        m_pMeta->m_TaskListEntries.push_back(tle);
+        tasks.push_back(tle.id);
+      }
+    } else if (category == OperationCategory::emu) {
+      int emu_start;
+      {
+        std::string blob_name = to_string("task-", taskIndex, "-addr0");
+
+        ILoadable::Blob b;
+        b.name         = blob_name;
+        b.size         = sizeof(struct emu_network_desc);
+        b.interface    = ILoadable::Interface_EMU1;
+        b.subInterface = 0;
+        assign(b.version, m_EmuVersion);
+
+        NvU8* blob_data = new NvU8[b.size];
+
+        m_pMeta->m_EmuNetworkDesc.operation_desc_index        = m_pMeta->m_AddressListEntries.size() + 1;
+        m_pMeta->m_EmuNetworkDesc.operation_buffer_desc_index = m_pMeta->m_AddressListEntries.size() + 2;
+        m_pMeta->m_EmuNetworkDesc.num_operations              = m_NumRois * numTasks;
+        memcpy(blob_data, &(m_pMeta->m_EmuNetworkDesc), sizeof(struct emu_network_desc));
+
+        m_pMeta->m_Loadable.priv()->setSymbolContent(blob_name, b, blob_data);
+        emu_start = submitMemAllocAddress(b.size, blob_name);
+      }
+
+      {
+        std::string blob_name = to_string("task-", taskIndex, "-op_list");
+
+        ILoadable::Blob b;
+        b.name         = blob_name;
+        b.size         = m_NumRois * numTasks * sizeof(union emu_operation_container);
+        b.interface    = ILoadable::Interface_EMU1;
+        b.subInterface = 0;
+        assign(b.version, m_EmuVersion);
+
+        // EMU has no notion of ROIs, so its operations are repeated for each of them
+        NvU8*                          blob_data = new NvU8[b.size];
+        union emu_operation_container* op_blob   = (union emu_operation_container*)blob_data;
+        for (unsigned roi = 0; roi < m_NumRois; ++roi) {
+          for (std::size_t i = iTaskStart; i < iTaskEnd; i++) {
+            const auto& opMeta = m_pMeta->m_OperationMetas[i];
+
+            NvDlaEmuOperation* op = m_pMeta->m_EMUOperationList[opMeta.index];
+            memcpy(op_blob + roi * numTasks + (i - iTaskStart), &(op->op_desc), sizeof(union emu_operation_container));
+          }
+        }
+
+        m_pMeta->m_Loadable.priv()->setSymbolContent(blob_name, b, blob_data);
+        submitMemAllocAddress(b.size, blob_name);
+      }
+
+      {
+        std::string blob_name = to_string("task-", taskIndex, "-op_buf_list");
+
+        ILoadable::Blob b;
+        b.name         = blob_name;
+        b.size         = m_NumRois * numTasks * sizeof(union emu_operation_buffer_container);
+        b.interface    = ILoadable::Interface_EMU1;
+        b.subInterface = 0;
+        assign(b.version, m_EmuVersion);
+
+        NvU8*                                 blob_data = new NvU8[b.size];
+        union emu_operation_buffer_container* op_blob   = (union emu_operation_buffer_container*)blob_data;
+        for (unsigned roi = 0; roi < m_NumRois; ++roi) {
+          for (std::size_t i = iTaskStart; i < iTaskEnd; i++) {
+            const auto& opMeta = m_pMeta->m_OperationMetas[i];
+
+            NvDlaEmuOperation*                   op      = m_pMeta->m_EMUOperationList[opMeta.index];
+            union emu_operation_buffer_container buffers = op->op_buf;
+            if (0 < roi) {
+              for (NvS16* address : getAddresses(buffers, op->op_desc.power_op.common.op_type)) {
+                *address = getRoiAddress(*address, roi);
+              }
+            }
+            memcpy(op_blob + roi * numTasks + (i - iTaskStart), &buffers,
+                   sizeof(union emu_operation_buffer_container));
+          }
+        }
+
+        m_pMeta->m_Loadable.priv()->setSymbolContent(blob_name, b, blob_data);
+        submitMemAllocAddress(b.size, blob_name);
+      }
+
+      {
+        for (int i = 0; i < 3; i++) {
+          ILoadable::MemoryListEntry mle;
+          mle.id             = m_pMeta->m_MemoryListEntries.size();
+          mle.alignment      = 4096;
+          mle.bind_id        = 0;
+          mle.domain         = ILoadable::MemoryDomain_SYSMEM;
+          mle.flags          = ILoadable::MemoryFlags_ALLOC;
+          mle.size           = 4096;
+          mle.tensor_desc_id = 0;
+          m_pMeta->m_MemoryListEntries.push_back(mle);
+
+          ILoadable::AddressListEntry ale;
+          ale.size   = 0;
+          ale.offset = 0;
+          ale.mem_id = mle.id;
+          ale.id     = m_pMeta->m_AddressListEntries.size();
+          m_pMeta->m_AddressListEntries.push_back(ale);
+        }
+
+        ILoadable::TaskListEntry tle;
+
+        tle.id        = m_pMeta->m_TaskListEntries.size();
+        tle.interface = ILoadable::Interface_EMU1;
+        tle.instance  = -1;
+
+        tle.preactions.push_back(submitEvent(tle.id, NVDLA_LOADABLE_EVENT_OP_WAIT));
+        tle.postactions.push_back(submitEvent(tle.id, NVDLA_LOADABLE_EVENT_OP_SIGNAL));
+        tle.address_list.push_back(emu_start);
+        for (int i = 1; i < m_pMeta->m_AddressListEntries.size(); i++)
+          tle.address_list.push_back(i);
+        m_pMeta->m_TaskListEntries.push_back(tle);
+        tasks.push_back(tle.id);
+      }
+    }
+
+    iTaskStart = iTaskEnd;
+  }
+
+  if (m_Streaming) {
+    submitPipelined(tasks);
+  } else {
+    for (TaskListEntryId task : tasks) {
+      ILoadable::SubmitListEntry sle;
+      sle.id = m_pMeta->m_SubmitListEntries.size();
+      sle.tasks.push_back(task);
+      m_pMeta->m_SubmitListEntries.push_back(sle);
+    }
+  }
+
+  return Pass::kModuleNoChanged;
+}
+
+void NvDlaTaskSubmitPass::submitPipelined(const std::vector<TaskListEntryId>& tasks)
+{
+  // Every task of the second frame reads and writes its own copy of the inputs,
+  // outputs and activations.
+  const std::unordered_map<AddressListEntryId, AddressListEntryId> remap = duplicateFrameMemory();
+
+  std::vector<TaskListEntryId> nextFrameTasks;
+  for (TaskListEntryId task : tasks) {
+    ILoadable::TaskListEntry tle = m_pMeta->m_TaskListEntries[task];
+    tle.id                       = m_pMeta->m_TaskListEntries.size();
+
+    for (auto& address : tle.address_list) {
+      const auto found = remap.find(address);
+      if (found != remap.end()) {
+        address = found->second;
+      }
+    }
+
+    tle.preactions.clear();
+    for (NvU16 event : m_pMeta->m_TaskListEntries[task].preactions) {
+      tle.preactions.push_back(submitEvent(tle.id, m_pMeta->m_EventListEntries[event].op));
+    }
+    tle.postactions.clear();
+    for (NvU16 event : m_pMeta->m_TaskListEntries[task].postactions) {
+      tle.postactions.push_back(submitEvent(tle.id, m_pMeta->m_EventListEntries[event].op));
+    }
+
+    m_pMeta->m_TaskListEntries.push_back(tle);
+    nextFrameTasks.push_back(tle.id);
+  }
+
+  // Adjacent tasks run on different processors (the CPU or another NVDLA
+  // core), so stage i pairs task i of frame n with task i - 1 of frame n + 1:
+  //
+  //   stage:      0      1       2       ...  k
+  //   frame n:    T0     T1      T2           -
+  //   frame n+1:  -      T0      T1           Tk-1
+  for (std::size_t stage = 0; stage <= tasks.size(); ++stage) {
+    ILoadable::SubmitListEntry sle;
+    sle.id = m_pMeta->m_SubmitListEntries.size();
+    if (stage < tasks.size()) {
+      sle.tasks.push_back(tasks[stage]);
+    }
+    if (0 < stage) {
+      sle.tasks.push_back(nextFrameTasks[stage - 1]);
+    }
+    m_pMeta->m_SubmitListEntries.push_back(sle);
+  }
+}
+
+std::unordered_map<AddressListEntryId, AddressListEntryId> NvDlaTaskSubmitPass::duplicateFrameMemory()
+{
+  const NvDlaBackendMeta::MemoryFlags ioFlags = ILoadable::MemoryFlags_INPUT | ILoadable::MemoryFlags_OUTPUT;
+
+  // the second frame is bound after every input and output of the first one
+  unsigned numBindings[2] = {0, 0};
+  for (const ILoadable::MemoryListEntry& mle : m_pMeta->m_MemoryListEntries) {
+    if ((mle.flags & ioFlags) != 0) {
+      ++numBindings[(mle.flags & ILoadable::MemoryFlags_OUTPUT) != 0];
+    }
+  }
+
+  // everything the tasks write or the runtime binds is per frame, weights (ALLOC | SET) are shared
+  std::unordered_map<MemoryListEntryId, MemoryListEntryId> memoryRemap;
+  for (const auto& tensorMemory : m_pMeta->m_MemIdxTable) {
+    const MemoryListEntryId memoryId = tensorMemory.second;
+    if (memoryRemap.count(memoryId) != 0 ||
+        (m_pMeta->m_MemoryListEntries[memoryId].flags & ILoadable::MemoryFlags_SET) != 0) {
+      continue;
+    }
+
+    ILoadable::MemoryListEntry mle = m_pMeta->m_MemoryListEntries[memoryId];
+    mle.id                         = m_pMeta->m_MemoryListEntries.size();
+    if ((mle.flags & ioFlags) != 0) {
+      mle.bind_id += numBindings[(mle.flags & ILoadable::MemoryFlags_OUTPUT) != 0];
+
+      ILoadable::TensorDescListEntry tensorDesc = m_pMeta->m_TensorDescListEntries[mle.tensor_desc_id];
+      tensorDesc.id    = m_pMeta->m_TensorDescListEntries.size();
+      tensorDesc.memId = mle.id;
+      tensorDesc.name += "_1";
+      m_pMeta->m_TensorDescListEntries.push_back(tensorDesc);
+
+      mle.tensor_desc_id = tensorDesc.id;
+    }
+    m_pMeta->m_MemoryListEntries.push_back(mle);
+    memoryRemap.emplace(memoryId, mle.id);
+  }
+
+  std::unordered_map<AddressListEntryId, AddressListEntryId> addressRemap;
+  const std::size_t numAddresses = m_pMeta->m_AddressListEntries.size();
+  for (std::size_t idx = 0; idx < numAddresses; ++idx) {
+    const auto found = memoryRemap.find(m_pMeta->m_AddressListEntries[idx].mem_id);
+    if (found == memoryRemap.end()) {
+      continue;
+    }
+
+    ILoadable::AddressListEntry ale = m_pMeta->m_AddressListEntries[idx];
+    ale.id                          = m_pMeta->m_AddressListEntries.size();
+    ale.mem_id                      = found->second;
+    m_pMeta->m_AddressListEntries.push_back(ale);
+    addressRemap.emplace(m_pMeta->m_AddressListEntries[idx].id, ale.id);
+  }
+
+  return addressRemap;
+}
+
+void NvDlaTaskSubmitPass::prepareRois()
+{
+  using namespace internal;
+
+  // Inputs, outputs and activations get one slice per ROI, weights (ALLOC | SET)
+  // are shared. The firmware runs an operation for every ROI before its
+  // consumers, so the results of all ROIs are live at once. The activation
+  // arena is sliced as a whole: each ROI reuses the offsets of ROI 0, which
+  // the liveness of one ROI already made safe.
+  for (const auto& tensorMemory : m_pMeta->m_MemIdxTable) {
+    ILoadable::MemoryListEntry& mle = m_pMeta->m_MemoryListEntries[tensorMemory.second];
+    if (m_RoiStrides.count(mle.id) != 0 || (mle.flags & ILoadable::MemoryFlags_SET) != 0) {
+      continue;
+    }
+
+    m_RoiStrides.emplace(mle.id, mle.size);
+    mle.size *= m_NumRois;
+  }
+
+  // the application fills the crops one after another, like a batch
+  for (ILoadable::TensorDescListEntry& tensorDesc : m_pMeta->m_TensorDescListEntries) {
+    if (m_RoiStrides.count(tensorDesc.memId) != 0) {
+      tensorDesc.size *= m_NumRois;
+      tensorDesc.dims.n *= m_NumRois;
+    }
+  }
+
+  // Task blobs refer to the address list by position, so every ROI address
+  // must exist before the first blob is submitted.
+  for (unsigned roi = 1; roi < m_NumRois; ++roi) {
+    for (NvDlaDlaOperation* op : m_pMeta->m_DLAOperationList) {
+      union dla_surface_container surface = op->op_surf;
+      for (std::int16_t* address : getAddresses(surface, op->op_dep.op_type)) {
+        getRoiAddress(*address, roi);
+      }
+    }
+
+    for (NvDlaEmuOperation* op : m_pMeta->m_EMUOperationList) {
+      union emu_operation_buffer_container buffers = op->op_buf;
+      for (NvS16* address : getAddresses(buffers, op->op_desc.power_op.common.op_type)) {
+        getRoiAddress(*address, roi);
+      }
+    }
+  }
+}
+
+AddressListEntryId NvDlaTaskSubmitPass::getRoiAddress(AddressListEntryId address, unsigned roi)
+{
+  // address 0 is the dummy entry which unused cubes refer to
+  if (roi == 0 || address <= 0) {
+    return address;
+  }
+
+  const ILoadable::AddressListEntry entry = m_pMeta->m_AddressListEntries[address];
+  const auto                        found = m_RoiStrides.find(entry.mem_id);
+  if (found == m_RoiStrides.end()) {
+    return address;
+  }
+
+  return m_pMeta->acquireMemory(entry.mem_id, entry.offset + roi * found->second, entry.size);
+}
+
+int NvDlaTaskSubmitPass::submitEvent(int task_id, int event_type)
+{
+  ILoadable::EventListEntry ele;
+  ele.id     = m_pMeta->m_EventListEntries.size();
+  ele.op     = event_type;
+  ele.target = 0;
+  ele.val    = task_id + ele.op;
+
+  m_pMeta->m_EventListEntries.push_back(ele);
+  return ele.id;
+}
+
+int NvDlaTaskSubmitPass::submitMemAllocAddress(int size, std::string blob_name)
+{
+  int aid = m_pMeta->m_AddressListEntries.size();
+
+  ILoadable::AddressListEntry ale;
+
+  ILoadable::MemoryListEntry mle;
+  mle.size           = size;
+  mle.id             = m_pMeta->m_MemoryListEntries.size();
+  mle.alignment      = 4096;
+  mle.flags          = ILoadable::MemoryFlags_ALLOC | ILoadable::MemoryFlags_SET;
+  mle.domain         = ILoadable::MemoryDomain_SYSMEM;
+  mle.bind_id        = 0;
+  mle.tensor_desc_id = 0;
+  mle.contents.push_back(blob_name);
+  mle.offsets.push_back(0);
+  m_pMeta->m_MemoryListEntries.push_back(mle);
+
+  ale.size   = 0;
+  ale.offset = 0;
+  ale.mem_id = mle.id;
+  ale.id     = aid;
+
+  m_pMeta->m_AddressListEntries.push_back(ale);
+  return aid;
+}
+} // namespace foonvdla
+} // namespace onnc
@@ -0,0 +1,75 @@
+//===- NvDlaTaskSubmitPass.h ----------------------------------------------===//
+//
+//                             The ONNC Project
+//
+// See LICENSE.TXT for details.
+//
+//===----------------------------------------------------------------------===//
+#ifndef ONNC_NVDLAM_TASKSUBMIT_PASS_H
+#define ONNC_NVDLAM_TASKSUBMIT_PASS_H
+
+#include "NvDlaMeta.h"
+#include "Version.h"
+
+#include <onnc/Core/CustomPass.h>
+
+#include <unordered_map>
+#include <vector>
+
+namespace onnc {
+class TargetBackend;
+
+namespace foonvdla {
+
+/** \class NvDlaTaskSubmitPass
+ *  \brief Group operations into DLA and EMU tasks and decide the submit order.
+ *
+ *  In streaming mode a second copy of every task is emitted for the next frame,
+ *  with its own input, output and activation buffers, and the submits are
+ *  software pipelined so that the DLA tasks of frame n+1 run while the EMU
+ *  tasks of frame n do. The inputs and outputs of the second frame are bound
+ *  after those of the first one.
+ *
+ *  With more than one ROI, inputs, outputs and activations get one slice per
+ *  ROI. DLA operations are shared, their dependency descriptors are repeated
+ *  with the index of each ROI and their surfaces with the addresses of each
+ *  slice; EMU operations are repeated as a whole.
+ */
+class NvDlaTaskSubmitPass : public CustomPass<NvDlaTaskSubmitPass>
+{
+public:
+  using TaskListEntryId = decltype(std::declval<ILoadable::TaskListEntry>().id);
+
+public:
+  NvDlaTaskSubmitPass(NvDlaBackendMeta* pMeta, Version pDlaVersion, Version pEmuVersion, bool pStreaming = false,
+                      unsigned pNumRois = 1);
+
+  ReturnType runOnModule(Module& pModule) override;
+  int        submitEvent(int task_id, int event_type);
+  int        submitMemAllocAddress(int size, std::string blob_name);
+
+private:
+  void submitPipelined(const std::vector<TaskListEntryId>& tasks);
+
+  /// Allocate a second buffer for each input, output and activation, and
+  /// return the address remapping.
+  std::unordered_map<AddressListEntryId, AddressListEntryId> duplicateFrameMemory();
+
+  void prepareRois();
+
+  /// Address of the same buffer in the slice of @ref roi.
+  AddressListEntryId getRoiAddress(AddressListEntryId address, unsigned roi);
+
+private:
+  NvDlaBackendMeta* m_pMeta;
+  const Version     m_DlaVersion;
+  const Version     m_EmuVersion;
+  const bool        m_Streaming;
+  const unsigned    m_NumRois;
+  // ROI slice size of each memory list entry which is sliced
+  std::unordered_map<MemoryListEntryId, NvDlaBackendMeta::Size> m_RoiStrides;
+};
+} // namespace foonvdla
+} // namespace onnc
+
+#endif
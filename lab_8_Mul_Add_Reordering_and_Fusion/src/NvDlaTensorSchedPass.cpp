@@ -0,0 +1,385 @@
+//===- NvDlaTensorSchedPass.cpp -------------------------------------------===//
+//
+//                             The ONNC Project
+//
+// See LICENSE.TXT for details.
+//
+//===----------------------------------------------------------------------===//
+#include "NvDlaTensorSchedPass.h"
+
+#include "NvDlaUtil.h"
+
+#include <onnc/Core/PassSupport.h>
+#include <onnc/IR/Compute/OutputOperator.h>
+#include <onnc/IR/ComputeOperator.h>
+#include <onnc/Support/Casting.h>
+
+#include <algorithm>
+#include <array>
+#include <cassert>
+#include <cstdint>
+#include <iostream>
+#include <set>
+#include <tuple>
+#include <unordered_map>
+#include <utility>
+
+namespace onnc {
+namespace foonvdla {
+
+namespace internal {
+
+bool isGraphOutput(const Tensor& tensor)
+{
+  for (const auto& use : tensor.getUses()) {
+    if (isa<OutputOperator>(use.getUser())) {
+      return true;
+    }
+  }
+  return false;
+}
+
+/** \class ReadyList
+ *  \brief Operators whose producers are all scheduled, and the memory growth
+ *  of scheduling each of them next.
+ *
+ *  The growth of a ready operator only changes when another consumer of one
+ *  of its inputs is scheduled, so only those are updated at each step.
+ */
+class ReadyList : private NvDlaConstants
+{
+public:
+  using OperatorList = NvDlaTensorSchedPass::OperatorList;
+  using Delta        = std::int64_t;
+
+public:
+  ReadyList(const NvDlaConstants& constants, const OperatorList& pOrder)
+    : NvDlaConstants{constants}
+    , m_Order{pOrder}
+  {
+    for (std::size_t idx = 0; idx < pOrder.size(); ++idx) {
+      m_Position.emplace(pOrder[idx], idx);
+    }
+
+    for (ComputeOperator* op : pOrder) {
+      for (unsigned idx = 0; idx < op->getNumOfOutputs(); ++idx) {
+        if (const Tensor* output = dynamic_cast<const Tensor*>(op->getOutput(idx))) {
+          m_NumPendingUses[output] = output->getUses().size();
+        }
+      }
+    }
+
+    for (ComputeOperator* op : pOrder) {
+      unsigned& numPending = m_NumPendingInputs[op];
+      for (unsigned idx = 0; idx < op->getNumOfInputs(); ++idx) {
+        const Tensor* input = dynamic_cast<const Tensor*>(op->getInput(idx));
+        if (input != nullptr && m_Position.count(getProducer(*input)) != 0) {
+          ++numPending;
+        }
+      }
+
+      if (numPending == 0) {
+        makeReady(op);
+      }
+    }
+  }
+
+  bool empty() const { return m_Ready.empty(); }
+
+  const std::vector<ComputeOperator*>& getOperators() const { return m_Ready; }
+
+  std::size_t getPosition(const ComputeOperator* op) const { return m_Position.at(op); }
+
+  /// Memory growth if @ref op is scheduled now: its outputs become live, and
+  /// the inputs it is the last consumer of die.
+  Delta getDelta(const ComputeOperator* op) const { return m_Deltas.at(op); }
+
+  /// The ready operator with the smallest memory growth; ties keep the original order.
+  ComputeOperator* getSmallest() const
+  {
+    assert(!empty());
+    return m_Order[m_ByDelta.begin()->second];
+  }
+
+  /// Remove @ref op from the list, and add the users it makes ready.
+  void schedule(ComputeOperator* op)
+  {
+    const auto found = std::find(m_Ready.begin(), m_Ready.end(), op);
+    assert(found != m_Ready.end() && "only ready operators can be scheduled");
+    m_Ready.erase(found);
+    m_ByDelta.erase(std::make_pair(m_Deltas.at(op), getPosition(op)));
+    m_Deltas.erase(op);
+
+    for (unsigned idx = 0; idx < op->getNumOfInputs(); ++idx) {
+      if (const Tensor* input = dynamic_cast<const Tensor*>(op->getInput(idx))) {
+        --m_NumPendingUses[input];
+      }
+    }
+
+    // the other ready consumers of the inputs may become their last consumer
+    for (unsigned idx = 0; idx < op->getNumOfInputs(); ++idx) {
+      const Tensor* input = dynamic_cast<const Tensor*>(op->getInput(idx));
+      if (input == nullptr) {
+        continue;
+      }
+
+      for (const auto& use : input->getUses()) {
+        const ComputeOperator* user  = use.getUser();
+        const auto             delta = m_Deltas.find(user);
+        if (delta != m_Deltas.end()) {
+          m_ByDelta.erase(std::make_pair(delta->second, getPosition(user)));
+          delta->second = computeDelta(user);
+          m_ByDelta.emplace(delta->second, getPosition(user));
+        }
+      }
+    }
+
+    for (unsigned idx = 0; idx < op->getNumOfOutputs(); ++idx) {
+      const Tensor* output = dynamic_cast<const Tensor*>(op->getOutput(idx));
+      if (output == nullptr) {
+        continue;
+      }
+
+      for (const auto& use : output->getUses()) {
+        ComputeOperator* user = use.getUser();
+        if (m_Position.count(user) != 0 && --m_NumPendingInputs[user] == 0) {
+          makeReady(user);
+        }
+      }
+    }
+  }
+
+private:
+  void makeReady(ComputeOperator* op)
+  {
+    const Delta delta = computeDelta(op);
+    m_Ready.emplace_back(op);
+    m_Deltas.emplace(op, delta);
+    m_ByDelta.emplace(delta, getPosition(op));
+  }
+
+  Delta computeDelta(const ComputeOperator* op) const
+  {
+    Delta delta = 0;
+    for (unsigned idx = 0; idx < op->getNumOfOutputs(); ++idx) {
+      const Tensor* output = dynamic_cast<const Tensor*>(op->getOutput(idx));
+      if (output != nullptr && NvDlaLiveness::isActivation(*output)) {
+        delta += NvDlaLiveness::getTensorSize(*this, *output);
+      }
+    }
+
+    std::unordered_map<const Tensor*, std::size_t> numUses;
+    for (unsigned idx = 0; idx < op->getNumOfInputs(); ++idx) {
+      if (const Tensor* input = dynamic_cast<const Tensor*>(op->getInput(idx))) {
+        ++numUses[input];
+      }
+    }
+    for (const auto& inputUses : numUses) {
+      const Tensor* input = inputUses.first;
+      const auto    found = m_NumPendingUses.find(input);
+      if (NvDlaLiveness::isActivation(*input) && !isGraphOutput(*input) && found != m_NumPendingUses.end() &&
+          found->second == inputUses.second) {
+        delta -= NvDlaLiveness::getTensorSize(*this, *input);
+      }
+    }
+    return delta;
+  }
+
+private:
+  const OperatorList&                                     m_Order;
+  std::unordered_map<const ComputeOperator*, std::size_t> m_Position;
+  // # of inputs whose producer is not scheduled yet, and # of uses not scheduled yet.
+  std::unordered_map<const ComputeOperator*, unsigned> m_NumPendingInputs;
+  std::unordered_map<const Tensor*, std::size_t>       m_NumPendingUses;
+  std::vector<ComputeOperator*>                        m_Ready;
+  // memory growth of the ready operators, and them ordered by it and their positions
+  std::unordered_map<const ComputeOperator*, Delta> m_Deltas;
+  std::set<std::pair<Delta, std::size_t>>           m_ByDelta;
+};
+
+/** \class EngineTimeline
+ *  \brief Busy time of every engine. An operator starts after its engine is
+ *  free and all its producers have finished.
+ */
+class EngineTimeline
+{
+public:
+  using Cycles = NvDlaPerfModel::Cycles;
+
+public:
+  explicit EngineTimeline(const NvDlaPerfModel& model)
+    : m_Model{model}
+  {
+    m_EngineFree.fill(0);
+  }
+
+  Cycles getStart(const ComputeOperator* op) const
+  {
+    const NvDlaEngine engine = NvDlaEngineModel::getEngine(*op);
+    Cycles            start  = (engine == NvDlaEngine::kNone ? 0 : m_EngineFree[static_cast<unsigned>(engine)]);
+    for (unsigned idx = 0; idx < op->getNumOfInputs(); ++idx) {
+      const Tensor* input = dynamic_cast<const Tensor*>(op->getInput(idx));
+      if (input == nullptr) {
+        continue;
+      }
+
+      const auto found = m_Finish.find(getProducer(*input));
+      if (found != m_Finish.end()) {
+        start = std::max(start, found->second);
+      }
+    }
+    return start;
+  }
+
+  void run(const ComputeOperator* op)
+  {
+    const NvDlaEngine engine = NvDlaEngineModel::getEngine(*op);
+    const Cycles      finish = getStart(op) + m_Model.estimate(*op).cycles;
+    if (engine != NvDlaEngine::kNone) {
+      m_EngineFree[static_cast<unsigned>(engine)] = finish;
+    }
+    m_Finish[op] = finish;
+    m_Makespan   = std::max(m_Makespan, finish);
+  }
+
+  Cycles getMakespan() const { return m_Makespan; }
+
+private:
+  const NvDlaPerfModel&                                               m_Model;
+  std::array<Cycles, static_cast<unsigned>(NvDlaEngine::kNumEngines)> m_EngineFree;
+  std::unordered_map<const ComputeOperator*, Cycles>                  m_Finish;
+  Cycles                                                              m_Makespan = 0;
+};
+
+} // namespace internal
+
+//===----------------------------------------------------------------------===//
+// NvDlaTensorSchedPass
+//===----------------------------------------------------------------------===//
+NvDlaTensorSchedPass::NvDlaTensorSchedPass(const NvDlaConstants& constants, NvDlaBackendMeta* pMeta,
+                                           const NvDlaPerfModel& perfModel, NvDlaSchedPolicy policy,
+                                           bool deterministic) noexcept
+  : NvDlaConstants{constants}
+  , m_pMeta{pMeta}
+  , m_PerfModel{perfModel}
+  , m_Policy{policy}
+  , m_Deterministic{deterministic}
+{}
+
+Pass::ReturnType NvDlaTensorSchedPass::runOnModule(Module& pModule)
+{
+  const OperatorList original  = NvDlaLiveness::getOperatorList(*pModule.getRootComputeGraph());
+  const OperatorList scheduled = (m_Policy == NvDlaSchedPolicy::kMemory ? scheduleForMemory(*this, original)
+                                                                        : scheduleForConcurrency(original));
+
+  const NvDlaLiveness::Size before       = NvDlaLiveness(*this, original).getPeakBytes();
+  const NvDlaLiveness::Size after        = NvDlaLiveness(*this, scheduled).getPeakBytes();
+  const Cycles              cyclesBefore = estimateCycles(original);
+  const Cycles              cyclesAfter  = estimateCycles(scheduled);
+
+  // The greedy order is not guaranteed to be better, keep the topological one
+  // otherwise. Concurrency never costs a higher peak.
+  bool isBetter = (after < before);
+  if (m_Policy == NvDlaSchedPolicy::kConcurrency) {
+    isBetter = (after <= before && (cyclesAfter < cyclesBefore || (cyclesAfter == cyclesBefore && after < before)));
+  }
+  m_pMeta->m_OperatorSchedule = (isBetter ? scheduled : original);
+
+  std::cout << "NvDlaTensorSchedPass: peak live activation bytes " << before << " -> " << (isBetter ? after : before)
+            << ", estimated cycles " << cyclesBefore << " -> " << (isBetter ? cyclesAfter : cyclesBefore) << "\n";
+
+  return Pass::kModuleNoChanged;
+}
+
+NvDlaTensorSchedPass::Cycles NvDlaTensorSchedPass::estimateCycles(const OperatorList& pOrder) const
+{
+  internal::EngineTimeline timeline(m_PerfModel);
+  for (const ComputeOperator* op : pOrder) {
+    timeline.run(op);
+  }
+  return timeline.getMakespan();
+}
+
+NvDlaTensorSchedPass::OperatorList NvDlaTensorSchedPass::scheduleForMemory(const NvDlaConstants& constants,
+                                                                           const OperatorList&   pOrder)
+{
+  internal::ReadyList ready(constants, pOrder);
+  OperatorList        schedule;
+  schedule.reserve(pOrder.size());
+  while (!ready.empty()) {
+    ComputeOperator* best = ready.getSmallest();
+    ready.schedule(best);
+    schedule.emplace_back(best);
+  }
+
+  assert(schedule.size() == pOrder.size() && "the compute graph should be acyclic");
+  return schedule;
+}
+
+NvDlaTensorSchedPass::OperatorList NvDlaTensorSchedPass::scheduleForConcurrency(const OperatorList& pOrder,
+                                                                                std::mt19937*       pRandom) const
+{
+  using Delta = internal::ReadyList::Delta;
+  using Key   = std::tuple<Cycles, Delta, std::size_t>;
+
+  internal::ReadyList      ready(*this, pOrder);
+  internal::EngineTimeline timeline(m_PerfModel);
+  OperatorList             schedule;
+  schedule.reserve(pOrder.size());
+  while (!ready.empty()) {
+    // pick the ready operator which starts earliest, then the one with the smallest memory growth.
+    ComputeOperator* best = nullptr;
+    Key              bestKey;
+    for (ComputeOperator* op : ready.getOperators()) {
+      const std::size_t tieBreak = (pRandom == nullptr ? ready.getPosition(op) : (*pRandom)());
+      const Key         key{timeline.getStart(op), ready.getDelta(op), tieBreak};
+      if (best == nullptr || key < bestKey) {
+        best    = op;
+        bestKey = key;
+      }
+    }
+
+    ready.schedule(best);
+    timeline.run(best);
+    schedule.emplace_back(best);
+  }
+
+  assert(schedule.size() == pOrder.size() && "the compute graph should be acyclic");
+  return schedule;
+}
+
+NvDlaTensorSchedPass::OperatorList NvDlaTensorSchedPass::scheduleForConcurrency(const OperatorList& pOrder) const
+{
+  OperatorList best = scheduleForConcurrency(pOrder, nullptr);
+  if (m_Deterministic) {
+    return best;
+  }
+
+  // # of randomized tie-breaks tried besides the deterministic one
+  const unsigned numTrials = 8;
+
+  // an order raising the peak of the original one is not taken, see runOnModule()
+  const NvDlaLiveness::Size limit = NvDlaLiveness(*this, pOrder).getPeakBytes();
+
+  std::random_device  seed;
+  std::mt19937        random(seed());
+  Cycles              bestCycles = estimateCycles(best);
+  NvDlaLiveness::Size bestPeak   = NvDlaLiveness(*this, best).getPeakBytes();
+  for (unsigned trial = 0; trial < numTrials; ++trial) {
+    OperatorList              candidate = scheduleForConcurrency(pOrder, &random);
+    const Cycles              cycles    = estimateCycles(candidate);
+    const NvDlaLiveness::Size peak      = NvDlaLiveness(*this, candidate).getPeakBytes();
+    if (peak > limit) {
+      continue;
+    }
+    if (bestPeak > limit || cycles < bestCycles || (cycles == bestCycles && peak < bestPeak)) {
+      best       = std::move(candidate);
+      bestCycles = cycles;
+      bestPeak   = peak;
+    }
+  }
+  return best;
+}
+
+} // namespace foonvdla
+} // namespace onnc
@@ -0,0 +1,77 @@
+//===- NvDlaTensorSchedPass.h ---------------------------------------------===//
+//
+//                             The ONNC Project
+//
+// See LICENSE.TXT for details.
+//
+//===----------------------------------------------------------------------===//
+#ifndef ONNC_FOONVDLA_TENSOR_SCHED_PASS_H
+#define ONNC_FOONVDLA_TENSOR_SCHED_PASS_H
+#include "NvDlaDefine.h"
+#include "NvDlaLiveness.h"
+#include "NvDlaMeta.h"
+#include "NvDlaPerfModel.h"
+
+#include <onnc/Core/CustomPass.h>
+
+#include <random>
+
+namespace onnc {
+namespace foonvdla {
+
+enum class NvDlaSchedPolicy : unsigned
+{
+  kMemory = 0,  // minimize the peak live activation bytes
+  kConcurrency  // minimize the estimated cycles by overlapping engines
+};
+
+/** \class NvDlaTensorSchedPass
+ *  \brief Reorder independent operators for memory or engine concurrency.
+ *
+ *  kMemory greedily picks the ready operator with the smallest memory growth.
+ *  kConcurrency is a list scheduler: it picks the ready operator which can
+ *  start earliest on its engine, so that operators on different engines are
+ *  interleaved, and breaks ties by memory growth. In deterministic mode the
+ *  remaining ties keep the original order; otherwise several randomized
+ *  tie-breaks are tried and the shortest one is kept. A kConcurrency order is
+ *  only taken if it does not raise the peak live activation bytes.
+ *
+ *  The chosen order is recorded in NvDlaBackendMeta::m_OperatorSchedule and is
+ *  followed by NvDlaCodeEmitPass.
+ */
+class NvDlaTensorSchedPass : public CustomPass<NvDlaTensorSchedPass>, private NvDlaConstants
+{
+public:
+  using OperatorList = NvDlaLiveness::OperatorList;
+  using Cycles       = NvDlaPerfModel::Cycles;
+
+public:
+  NvDlaTensorSchedPass(const NvDlaConstants& constants, NvDlaBackendMeta* pMeta, const NvDlaPerfModel& perfModel,
+                       NvDlaSchedPolicy policy = NvDlaSchedPolicy::kMemory, bool deterministic = true) noexcept;
+
+  ReturnType runOnModule(Module& pModule) override;
+
+  /// Cycles to finish @ref pOrder if every engine runs its operators in order.
+  Cycles estimateCycles(const OperatorList& pOrder) const;
+
+  /// The kMemory order of @ref pOrder, also tried by NvDlaMemInfoPass when the
+  /// activations exceed the DRAM budget.
+  static OperatorList scheduleForMemory(const NvDlaConstants& constants, const OperatorList& pOrder);
+
+private:
+  /// @param pRandom breaks ties randomly if not null, by the original order otherwise.
+  OperatorList scheduleForConcurrency(const OperatorList& pOrder, std::mt19937* pRandom) const;
+
+  OperatorList scheduleForConcurrency(const OperatorList& pOrder) const;
+
+private:
+  NvDlaBackendMeta* m_pMeta;
+  NvDlaPerfModel    m_PerfModel;
+  NvDlaSchedPolicy  m_Policy;
+  bool              m_Deterministic;
+};
+
+} // namespace foonvdla
+} // namespace onnc
+
+#endif
@@ -13,36 +13,107 @@
 #include <onnc/IR/ComputeOperator.h>
 #include <onnc/Transforms/Optimizations/OptimizationsUtils.h>
 
+#include <fstream>
+#include <iomanip>
+#include <iostream>
+#include <sstream>
+#include <utility>
+
 namespace onnc {
 namespace foonvdla {
 
 //===----------------------------------------------------------------------===//
 // PrintONNCIRPass
 //===----------------------------------------------------------------------===//
+unsigned PrintONNCIRPass::printIdx = 0;
+
+PrintONNCIRPass::PrintONNCIRPass(const NvDlaIRPrintOptions& pOptions, std::string pWhen, std::string pPassName)
+  : m_Options{pOptions}
+  , m_When{std::move(pWhen)}
+  , m_PassName{std::move(pPassName)}
+{}
 
 Pass::ReturnType PrintONNCIRPass::runOnModule(Module& pModule)
 {
-  const Pass::ReturnType ret = BaseType::runOnModule(pModule);
+  ComputeGraph* graph = pModule.getRootComputeGraph();
+  if (graph == nullptr) {
+    return Pass::kModuleNoChanged;
+  }
+
+  std::ostringstream buffer;
+  switch (m_Options.format) {
+  case NvDlaIRFormat::kText:
+    printText(*graph, buffer);
+    break;
+  case NvDlaIRFormat::kDot:
+    printDot(*graph, buffer);
+    break;
+  case NvDlaIRFormat::kBinary:
+    NvDlaIRSnapshot::take(*graph, m_Options).write(buffer);
+    break;
+  }
 
-  if (ret != kModuleNoChanged) {
-    pModule.eraseUnusedValues();
+  const std::string title = m_When + " " + m_PassName;
+  if (m_Options.directory.empty()) {
+    // a binary snapshot is not for the console
+    if (m_Options.format == NvDlaIRFormat::kBinary) {
+      std::cout << "=== PrintONNCIRPass: " << title << ", " << buffer.str().size() << " bytes of snapshot\n";
+      return Pass::kModuleNoChanged;
+    }
+    std::cout << "=== PrintONNCIRPass: " << title << " ======\n" << buffer.str() << "==========================\n";
+    return Pass::kModuleNoChanged;
   }
 
-  return ret;
+  const char* extension = (m_Options.format == NvDlaIRFormat::kText ? ".txt"
+                           : m_Options.format == NvDlaIRFormat::kDot ? ".dot"
+                                                                     : ".nvir");
+  std::ostringstream path;
+  path << m_Options.directory << "/" << std::setw(2) << std::setfill('0') << printIdx++ << "-" << m_When << "-"
+       << m_PassName << extension;
+
+  std::ofstream file(path.str(), std::ios::binary);
+  if (!file.write(buffer.str().data(), buffer.str().size())) {
+    std::cerr << "PrintONNCIRPass: cannot write " << path.str() << "\n";
+  }
+
+  return Pass::kModuleNoChanged;
 }
 
-Pass::ReturnType PrintONNCIRPass::runOnComputeGraph(ComputeGraph& pCG)
+void PrintONNCIRPass::printText(ComputeGraph& pCG, std::ostream& pOS) const
 {
-  Pass::ReturnType ret = Pass::kModuleNoChanged;
-
-  std::cout << "=== PrintONNCIRPass ======\n";
   for (ComputeOperator& node : pCG) {
-    node.print(std::cout);
-    std::cout << "\n";
+    if (m_Options.isPrinted(node)) {
+      node.print(pOS);
+      pOS << "\n";
+    }
   }
-  std::cout << "==========================\n";
-  
-  return ret;
+}
+
+void PrintONNCIRPass::printDot(ComputeGraph& pCG, std::ostream& pOS) const
+{
+  // Operators are numbered in the graph order, so two prints can be diffed.
+  pOS << "digraph {\n";
+
+  unsigned opIdx = 0;
+  for (ComputeOperator& op : pCG) {
+    if (!m_Options.isPrinted(op)) {
+      continue;
+    }
+
+    const std::string opName = "op" + std::to_string(opIdx++);
+    pOS << "  " << opName << " [label=\"" << op.name() << "\"]\n";
+
+    for (unsigned idx = 0; idx < op.getNumOfInputs(); ++idx) {
+      pOS << "  \"" << op.getInput(idx)->getName() << "\" -> " << opName << "\n";
+    }
+    for (unsigned idx = 0; idx < op.getNumOfOutputs(); ++idx) {
+      const std::string& output = op.getOutput(idx)->getName();
+      pOS << "  " << opName << " -> \"" << output << "\"\n";
+      pOS << "  \"" << output << "\" [shape=rect]\n";
+    }
+  }
+
+  pOS << "}\n";
 }
 
 } // namespace foonvdla
@@ -7,20 +7,42 @@
 //===----------------------------------------------------------------------===//
 #ifndef ONNC_FOONVDLA_PRINT_ONNC_IR_PASS_H
 #define ONNC_FOONVDLA_PRINT_ONNC_IR_PASS_H
+#include "NvDlaIRSnapshot.h"
+
 #include <onnc/Core/CustomPass.h>
-#include <utility>
+
+#include <ostream>
+#include <string>
 
 namespace onnc {
 namespace foonvdla {
 
+/** \class PrintONNCIRPass
+ *  \brief Print the ONNC IR graph right before or after a pass.
+ *
+ *  It is only added for the passes NvDlaIRPrintOptions asks for. The graph is
+ *  formatted into a buffer and written at once, to one file per print if a
+ *  directory is given, e.g. 03-after-NvDlaReorderMulAddPass.txt.
+ */
 class PrintONNCIRPass : public CustomPass<PrintONNCIRPass>
 {
 public:
-  PrintONNCIRPass() = default;
+  /// @param pWhen "before" or "after" @ref pPassName
+  PrintONNCIRPass(const NvDlaIRPrintOptions& pOptions, std::string pWhen, std::string pPassName);
 
   ReturnType runOnModule(Module& pModule) override;
 
-  ReturnType runOnComputeGraph(ComputeGraph& pCG) override;
+private:
+  void printText(ComputeGraph& pCG, std::ostream& pOS) const;
+
+  void printDot(ComputeGraph& pCG, std::ostream& pOS) const;
+
+private:
+  const NvDlaIRPrintOptions& m_Options;
+  std::string                m_When;
+  std::string                m_PassName;
+
+  static unsigned printIdx;
 };
 
 } // namespace foonvdla
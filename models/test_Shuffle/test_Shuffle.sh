@@ -0,0 +1,55 @@
+#!/bin/sh
+# Test the RUBIK emission of NvDlaShuffle (lab 7, step 5) on test_Shuffle.
+#
+# Within the onnc/onnc-community Docker container:
+#   $ sh /tutorial/models/test_Shuffle/test_Shuffle.sh compile
+# Within the virtual platform, after copying test_Shuffle/* to /usr/local/nvdla
+# and installing the KMD (insmod drm.ko && insmod opendla.ko):
+#   $ sh test_Shuffle.sh run
+#
+# Build ONNC with FooNvdlaBackend::FOLD_SHUFFLE = false first, otherwise the
+# Shuffle is folded into the first Conv and no RUBIK operation is emitted.
+# The Conv layers need a code emitting function as well, which lab 7 does not
+# provide, so the test cannot pass with the lab 7 backend alone.
+#
+# test_Shuffle.onnx shuffles 3 groups, so 2 + 2 * 3 RUBIK operations are
+# expected, and output.dimg must match test_Shuffle.output.dimg.
+
+GROUP=3
+DIR=$(dirname "$0")
+
+case "$1" in
+compile)
+  LOG=$(mktemp)
+  onnc -mquadruple foonvdla "$DIR/test_Shuffle.onnx" > "$LOG" || exit 1
+  cat "$LOG"
+  if grep -q "NvDlaFoldShufflePass" "$LOG"; then
+    echo "FAIL: the Shuffle was folded, rebuild ONNC with FooNvdlaBackend::FOLD_SHUFFLE = false"
+    rm -f "$LOG"
+    exit 1
+  fi
+  rm -f "$LOG"
+  sudo mv out.nvdla "$DIR/" || exit 1
+  ;;
+run)
+  dmesg -c > /dev/null
+  ./nvdla_runtime --loadable "$DIR/out.nvdla" --image "$DIR/input.pgm" --rawdump || exit 1
+
+  EXPECTED=$((2 + 2 * GROUP))
+  RUBIK=$(dmesg | grep -c "Completed RUBIK operation")
+  if [ "$RUBIK" -ne "$EXPECTED" ]; then
+    echo "FAIL: $RUBIK RUBIK operations, expected $EXPECTED"
+    exit 1
+  fi
+
+  if ! cmp -s output.dimg "$DIR/test_Shuffle.output.dimg"; then
+    echo "FAIL: output.dimg differs from test_Shuffle.output.dimg"
+    exit 1
+  fi
+  echo "PASS: $RUBIK RUBIK operations, output.dimg matches"
+  ;;
+*)
+  echo "usage: $0 compile|run"
+  exit 2
+  ;;
+esac